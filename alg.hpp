@@ -8,10 +8,21 @@
 #include <type_traits>
 #include <functional>
 #include <atomic>
-#include <future>
 #include <numeric>
-#include "IteratorWrapper.hpp"
+#include <optional>
+#include <vector>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include "algScratch.hpp"
 #include "algThreads.hpp"
+#include "algCutoff.hpp"
+#include "algStealing.hpp"
+#include "algMemory.hpp"
+#include "algSimd.hpp"
+#include "algStream.hpp"
+#include "algTiles.hpp"
+#include "algRandom.hpp"
 #include "all_is_same.hpp"
 namespace alg
 {
@@ -31,510 +42,3292 @@ template <class T, class... It>
 using _ifAnyNotRAIt = typename std::enable_if<!all_is_same<std::random_access_iterator_tag,
                                                        typename std::iterator_traits<It>::iterator_category...>::value, T>::type;
 
-template <typename _T1, typename _T2>
-struct _pair
+// Start of chunk i when n elements are cut into parts chunks whose sizes differ by at most one.
+inline size_t _chunkBegin(size_t n, size_t parts, size_t i)
 {
-    _T1 first;
-    _T2 second;
-};
+    return n / parts * i + std::min(i, n % parts);
+}
+
+inline alg::_Scratch<size_t> _splitBounds(size_t n, size_t parts)
+{
+    alg::_Scratch<size_t> res(parts + 1);
+    for (size_t i = 0; i <= parts; ++i)
+        res[i] = alg::_chunkBegin(n, parts, i);
+    return res;
+}
 
-template <typename _T1, typename _T2>
-alg::_pair<_T1, _T2> _make_pair(const _T1 & first, const _T2 & second)
+template <class RAIt>
+alg::_ifRAIt<RAIt, alg::_Scratch<RAIt>> _split(RAIt first, RAIt last, size_t parts)
 {
-    alg::_pair<_T1, _T2> res;
-    res.first = first;
-    res.second = second;
+    alg::_Scratch<RAIt> res(parts + 1);
+    size_t n = last - first;
+    for (size_t i = 0; i <= parts; ++i)
+        res[i] = first + alg::_chunkBegin(n, parts, i);
     return res;
 }
 
-template <typename _T1, typename _T2>
-std::pair<_T1, _T2> _to_std_pair(const alg::_pair<_T1, _T2> & item)
+// Walks n elements of all sequences together, once, and returns the iterators at the parts + 1
+// bounds of the _splitBounds chunks.
+template <class It, class... Others>
+alg::_Scratch<std::tuple<It, Others...>> _splitN(size_t n, size_t parts, It first, Others... others)
 {
-    return std::make_pair(item.first, item.second);
+    alg::_Scratch<std::tuple<It, Others...>> res(parts + 1);
+    res[0] = std::make_tuple(first, others...);
+    for (size_t i = 0; i < parts; ++i)
+    {
+        for (size_t k = alg::_chunkBegin(n, parts, i); k < alg::_chunkBegin(n, parts, i + 1); ++k)
+        {
+            ++first;
+            (++others, ...);
+        }
+        res[i + 1] = std::make_tuple(first, others...);
+    }
+    return res;
 }
 
-size_t * _splitSize(size_t n)
+// Same as _splitN when the length is unknown. The sequences are still walked only once: every
+// stride-th position is kept and the stride doubles whenever the samples fill up, so the chunk
+// bounds end up within n / (32 * parts) elements of an even split.
+template <class It, class... Others>
+alg::_Scratch<std::tuple<It, Others...>> _splitTogether(size_t parts, It first, const It & last, Others... others)
 {
-    size_t div = n / alg::_num_of_threads;
-    size_t mod = n % alg::_num_of_threads;
-    size_t * res = new size_t[alg::_num_of_threads];
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++i)
+    size_t capacity = 64 * parts;
+    alg::_Scratch<std::tuple<It, Others...>> samples(capacity);
+    size_t count = 0;
+    size_t stride = 1;
+    size_t n = 0;
+    for (; first != last; ++first, (++others, ...), ++n)
     {
-        res[i] = div;
-        if (mod)
+        if (n % stride != 0)
+            continue;
+        if (count == capacity)
         {
-            ++res[i];
-            --mod;
+            for (size_t k = 0; k < capacity / 2; ++k)
+                samples[k] = samples[2 * k];
+            count = capacity / 2;
+            stride *= 2;
         }
+        samples[count++] = std::make_tuple(first, others...);
     }
+    alg::_Scratch<std::tuple<It, Others...>> res(parts + 1);
+    for (size_t i = 0; i < parts; ++i)
+    {
+        size_t sample = (alg::_chunkBegin(n, parts, i) + stride / 2) / stride;
+        res[i] = sample < count ? samples[sample] : std::make_tuple(first, others...);
+    }
+    res[parts] = std::make_tuple(first, others...);
     return res;
 }
 
 template <class RAIt>
-RAIt * _split(RAIt first, RAIt last)
+alg::_ifRAIt<RAIt, size_t> _partsFor(alg::executor & ex, const RAIt & first, const RAIt & last)
+{
+    return alg::_partsFor(ex, last - first);
+}
+
+// The length is not known without walking the range.
+template <class It>
+alg::_ifnotRAIt<It, size_t> _partsFor(alg::executor & ex, const It &, const It &)
+{
+    return ex.concurrency();
+}
+
+// Instrumentation only counts the elements of random access chunks, for the others it would take a walk.
+template <class It>
+void _countRange(const It & first, const It & last)
 {
-    RAIt * res = new RAIt[alg::_num_of_threads + 1];
-    res[0] = first;
-    size_t * splitedSize = alg::_splitSize(last - first);
-    std::transform(res, res + alg::_num_of_threads, splitedSize, res + 1, std::plus<>());
-    delete[] splitedSize;
+    if constexpr (alg::instrumentation_enabled && std::is_same<typename std::iterator_traits<It>::iterator_category,
+                                                               std::random_access_iterator_tag>::value)
+        alg::_countElements(last - first);
+}
+
+template <class It>
+alg::_ifnotRAIt<It, alg::_Scratch<It>> _split(It first, It last, size_t parts)
+{
+    alg::_Scratch<It> res(parts + 1);
+    if (parts == 1)
+    {
+        res[0] = first;
+        res[1] = last;
+        return res;
+    }
+    alg::_Scratch<std::tuple<It>> bounds = alg::_splitTogether(parts, first, last);
+    for (size_t i = 0; i <= parts; ++i)
+        res[i] = std::get<0>(bounds[i]);
     return res;
 }
 
+template <class T>
+struct alignas(alg::_cache_line_size) _ReduceSlot
+{
+    std::optional<T> value;
+};
+
+template <class T, class ReduceFunc>
+void _mergeIntoSlot(alg::_ReduceSlot<T> & slot, T && partial, const ReduceFunc & reduceF)
+{
+    if (slot.value)
+        slot.value = reduceF(std::move(*slot.value), std::move(partial));
+    else
+        slot.value = std::move(partial);
+}
+
+template <class T, class It, class ReduceFunc, class TransformFunc>
+void _inThreadTransformReduce(alg::_ReduceSlot<T> & slot, It first, const It & last, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    if (first == last)
+        return;
+    T partial = transformF(*first);
+    for (++first; first != last; ++first)
+        partial = reduceF(std::move(partial), transformF(*first));
+    alg::_mergeIntoSlot(slot, std::move(partial), reduceF);
+}
+
+template <class T, class It1, class It2, class ReduceFunc, class TransformFunc>
+void _inThreadTransformReduce(alg::_ReduceSlot<T> & slot, It1 first1, const It1 & last1, It2 first2, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    if (first1 == last1)
+        return;
+    T partial = transformF(*first1, *first2);
+    for (++first1, ++first2; first1 != last1; ++first1, ++first2)
+        partial = reduceF(std::move(partial), transformF(*first1, *first2));
+    alg::_mergeIntoSlot(slot, std::move(partial), reduceF);
+}
+
+template <class T, class ReduceFunc>
+T _reduceSlots(alg::_ReduceSlot<T> * slots, size_t parts, T init, const ReduceFunc & reduceF)
+{
+    for (size_t i = 0; i < parts; ++i)
+        if (slots[i].value)
+            init = reduceF(std::move(init), std::move(*slots[i].value));
+    return init;
+}
+
+constexpr size_t _search_block_size = 1 << 14;
+
+// Searches are cut into blocks that are handed out in order; the stop flag is only checked between blocks.
+template <class It>
+alg::_ifRAIt<It, size_t> _searchBlocks(alg::executor & ex, const It & first, const It & last)
+{
+    return std::max(alg::_partsFor(ex, first, last), static_cast<size_t>(last - first) / alg::_search_block_size);
+}
+
+template <class It>
+alg::_ifnotRAIt<It, size_t> _searchBlocks(alg::executor & ex, const It &, const It &)
+{
+    return ex.concurrency() * 16;
+}
+
+// it moved forward by k, but not past last.
+template <class It>
+alg::_ifRAIt<It, It> _advanceUpTo(const It & it, const It & last, size_t k)
+{
+    return it + std::min(k, static_cast<size_t>(last - it));
+}
+
+template <class It>
+alg::_ifnotRAIt<It, It> _advanceUpTo(It it, const It & last, size_t k)
+{
+    for (; (k != 0) && (it != last); --k)
+        ++it;
+    return it;
+}
+
+inline void _atomicMin(std::atomic<size_t> & value, size_t candidate)
+{
+    size_t current = value.load(std::memory_order_relaxed);
+    while ((candidate < current) && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed));
+}
 
 template <class It, class Func>
-void _inThreadFindIfRAIt(It first, const It & last, const Func & f, std::atomic<It> & result, const It & trueLast)
+bool _inThreadFindIf(It & first, const It & last, const Func & f)
 {
-    for (; (first != last) && (static_cast<It>(result) == trueLast); ++first)
+    for (; first != last; ++first)
         if (f(*first))
-        {
-            result = first;
-            return;
-        }
+            return true;
+    return false;
 }
 
-template <class It, class Func>
-void _inThreadFindIfNotRAit(It first, const It & last, const Func & f, std::atomic<It> & result)
+// The predicate of find and count, so that their chunks can tell it from any other and use the kernels.
+template <class T>
+struct _EqualTo
+{
+    const T & item;
+
+    template <class U>
+    bool operator()(const U & value) const { return value == item; }
+};
+
+template <class It, class T>
+bool _inThreadFindIf(It & first, const It & last, const alg::_EqualTo<T> & f)
 {
-    while (true)
+    using V = typename std::iterator_traits<It>::value_type;
+    if constexpr (alg::_isSimdRange<It>::value)
     {
-        for (uint8_t i = 0; (i < alg::_num_of_threads) && (first != last); ++i, ++first);
-        if (static_cast<It>(result) != last)
-            return;
-        if (f(*first))
+        V value;
+        if ((first != last) && alg::_simdValue(f.item, value))
         {
-            result = first;
-            return;
+            size_t n = last - first;
+            size_t i = alg::_simdFind(alg::_toPointer(first), n, value);
+            first += i;
+            return i != n;
         }
     }
+    for (; first != last; ++first)
+        if (f(*first))
+            return true;
+    return false;
 }
 
-template <class It, class Func>
-alg::_ifRAIt<It, It> find_any_if(It first, const It & last, const Func & f)
+// best holds the lowest block with a match. Unordered searches stop as soon as any block matched,
+// ordered ones only skip blocks that come after it. A match covers window elements and belongs to the
+// block it starts in, so every block reads window - 1 elements into the next one; match(first, last)
+// returns the first match that fits in [first, last), or last.
+template <bool ordered, class It, class Match>
+It _findMatch(alg::executor & ex, const It & first, const It & last, size_t window, const Match & match)
 {
-    It * splited = alg::_split(first, last);
-    std::atomic<It> result = last;
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++i)
+    size_t blocks = alg::_searchBlocks(ex, first, last);
+    alg::_Scratch<It> splited = alg::_split(first, last, blocks);
+    alg::_Scratch<It> found(blocks);
+    std::atomic<size_t> best(blocks);
+    ex.run(blocks, [&](size_t i)
     {
-        alg::_threads[i] = std::thread(alg::_inThreadFindIfRAIt<It, Func>,
-                                  splited[i],
-                                  std::cref(splited[i + 1]),
-                                  std::cref(f),
-                                  std::ref(result),
-                                  std::cref(last));
-    }
-    alg::_joinAllThreads();
-    delete[] splited;
-    return static_cast<It>(result);
+        size_t current = best.load(std::memory_order_relaxed);
+        if (ordered ? (i > current) : (current != blocks))
+            return;
+        It end = alg::_advanceUpTo(splited[i + 1], last, window - 1);
+        found[i] = match(splited[i], end);
+        bool hit = found[i] != end;
+        alg::_countRange(splited[i], hit ? found[i] : splited[i + 1]);
+        if (hit)
+            alg::_atomicMin(best, i);
+    });
+    return best == blocks ? last : found[best];
 }
 
-template <class It, class Func>
-alg::_ifnotRAIt<It, It> find_any_if(It first, const It & last, const Func & f)
+template <bool ordered, class It, class Func>
+It _findIf(alg::executor & ex, const It & first, const It & last, const Func & f)
 {
-    std::atomic<It> result = last;
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++i, ++first)
+    return alg::_findMatch<ordered>(ex, first, last, 1, [&f](It current, const It & end)
     {
-        alg::_threads[i] = std::thread(alg::_inThreadFindIfNotRAit<It, Func>,
-                                  first,
-                                  std::cref(last),
-                                  std::cref(f),
-                                  std::ref(result));
-    }
-    alg::_joinAllThreads();
-    return static_cast<It>(result);
+        alg::_inThreadFindIf(current, end, f);
+        return current;
+    });
 }
 
-template <class It, class T>
-It find_any(const It & first, const It & last, const T & item)
+template <class It, class Func>
+It find_any_if(alg::executor & ex, const It & first, const It & last, const Func & f)
 {
-    return alg::find_any_if(first, last, std::bind(std::equal_to<>(), std::placeholders::_1, item));
+    alg::_CallScope scope("find_any_if");
+    return alg::_findIf<false>(ex, first, last, f);
 }
 
 template <class It, class Func>
-It find_any_if_not(const It & first, const It & last, const Func & f)
+It find_any_if(It first, const It & last, const Func & f)
 {
-    return alg::find_any_if(first, last, std::not_fn(f));
+    return alg::find_any_if(alg::default_executor(), first, last, f);
 }
 
 template <class It, class Func>
-bool all_of(const It & first, const It & last, const Func & f)
+It find_first_if(alg::executor & ex, const It & first, const It & last, const Func & f)
 {
-    It check = alg::find_any_if(first, last, std::not_fn(f));
-    return check == last;
+    alg::_CallScope scope("find_first_if");
+    return alg::_findIf<true>(ex, first, last, f);
 }
 
 template <class It, class Func>
-bool any_of(const It & first, const It & last, const Func & f)
+It find_first_if(const It & first, const It & last, const Func & f)
 {
-    It check = alg::find_any_if(first, last, f);
-    return check != last;
+    return alg::find_first_if(alg::default_executor(), first, last, f);
 }
 
-template <class It, class Func>
-bool none_of(const It & first, const It & last, const Func & f)
+template <class It, class T>
+It find(alg::executor & ex, const It & first, const It & last, const T & item)
 {
-    It check = alg::find_any_if(first, last, f);
-    return check == last;
+    alg::_CallScope scope("find");
+    return alg::find_first_if(ex, first, last, alg::_EqualTo<T>{item});
 }
 
-template <class It, class Func>
-alg::_ifRAIt<It, Func> for_each(It first, const It & last, const Func & f)
+template <class It, class T>
+It find(const It & first, const It & last, const T & item)
 {
-    It * splited = alg::_split(first, last);
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++i)
-    {
-        alg::_threads[i] = std::thread(std::for_each<It, Func>, splited[i], splited[i + 1], f);
-    }
-    alg::_joinAllThreads();
-    delete[] splited;
-    return std::move(f);
+    return alg::find(alg::default_executor(), first, last, item);
 }
 
-template <class It, class Func>
-alg::_ifnotRAIt<It, Func> for_each(It first, const It & last, const Func & f)
+template <class It, class T>
+It find_any(alg::executor & ex, const It & first, const It & last, const T & item)
 {
-    std::thread * beg = alg::_threads;
-    std::thread * end = alg::_threads + alg::_num_of_threads;
-    for (;beg != end; ++first, ++beg)
-    {
-        *beg = std::thread(std::for_each<alg::_IteratorWrapper<It>, Func>,
-                           alg::_IteratorWrapper<It>(first, last),
-                           alg::_IteratorWrapper<It>(last), f);
-    }
-    alg::_joinAllThreads();
-    return std::move(f);
+    alg::_CallScope scope("find_any");
+    return alg::find_any_if(ex, first, last, alg::_EqualTo<T>{item});
+}
+
+template <class It, class T>
+It find_any(const It & first, const It & last, const T & item)
+{
+    return alg::find_any(alg::default_executor(), first, last, item);
 }
 
 template <class It, class Func>
-alg::_ifRAIt<It, uint> count_if(It first, const It & last, const Func & f)
+It find_any_if_not(alg::executor & ex, const It & first, const It & last, const Func & f)
 {
-    It * splited = alg::_split(first, last);
-    std::future<long> * results = new std::future<long>[alg::_num_of_threads];
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++i)
-    {
-        results[i] = std::async(std::count_if<It, Func>, splited[i], splited[i + 1], std::cref(f));
-    }
-    long sum = std::accumulate(results, results + alg::_num_of_threads, 0, std::bind(std::plus<>(),
-                                                                                     std::placeholders::_1,
-                                                                                     std::bind(std::mem_fn(&std::future<long>::get),
-                                                                                               std::placeholders::_2)));
-    delete[] splited;
-    delete[] results;
-    return sum;
+    alg::_CallScope scope("find_any_if_not");
+    return alg::find_any_if(ex, first, last, std::not_fn(f));
 }
 
 template <class It, class Func>
-alg::_ifnotRAIt<It, uint> count_if(It first, const It & last, const Func & f)
+It find_any_if_not(const It & first, const It & last, const Func & f)
 {
-    std::future<long> * results = new std::future<long>[alg::_num_of_threads];
-    std::future<long> * beg = results;
-    std::future<long> * end = results + alg::_num_of_threads;
-    for (; beg != end; ++beg, ++first)
-    {
-        *beg = std::async(std::count_if<alg::_IteratorWrapper<It>, Func>,
-                          alg::_IteratorWrapper<It>(first, last),
-                          alg::_IteratorWrapper<It>(last),
-                          std::cref(f));
-    }
-    long sum = std::accumulate(results, results + alg::_num_of_threads, 0, std::bind(std::plus<>(),
-                                                                                     std::placeholders::_1,
-                                                                                     std::bind(std::mem_fn(&std::future<long>::get),
-                                                                                               std::placeholders::_2)));
-    delete[] results;
-    return sum;
+    return alg::find_any_if_not(alg::default_executor(), first, last, f);
 }
 
-template <class It1, class It2>
-void _inThreadAnyMismatch(It1 first1, const It1 & last1, It2 first2, const It1 & trueLast, std::atomic<alg::_pair<It1, It2>> & result)
+template <class It>
+It adjacent_find(alg::executor & ex, const It & first, const It & last)
 {
-    for(; (first1 != last1); ++first1, ++first2)
-    {
-        if (static_cast<alg::_pair<It1, It2>>(result).first != trueLast)
-            return;
-        if (*first1 != *first2)
-        {
-            result = alg::_make_pair(first1, first2);
-            return;
-        }
-    }
+    alg::_CallScope scope("adjacent_find");
+    return alg::_findMatch<true>(ex, first, last, 2, [](const It & begin, const It & end) { return std::adjacent_find(begin, end); });
 }
 
-template <class It1, class It2>
-alg::_ifAllRAIt<std::pair<It1, It2>, It1, It2> mismatch_any(It1 first1, const It1 & last1, It2 first2)
+template <class It>
+It adjacent_find(const It & first, const It & last)
 {
-    It1 * splited = alg::_split(first1, last1);
-    std::atomic<alg::_pair<It1, It2>> result = alg::_make_pair(last1, last1);
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++i, first2 += (splited[i] - splited[i - 1]))
-    {
-        alg::_threads[i] = std::thread(alg::_inThreadAnyMismatch<It1, It2>,
-                                  splited[i],
-                                  splited[i + 1],
-                                  first2,
-                                  std::cref(last1),
-                                  std::ref(result));
-    }
-    alg::_joinAllThreads();
-    delete[] splited;
-    return alg::_to_std_pair(static_cast<alg::_pair<It1, It2>>(result));
+    return alg::adjacent_find(alg::default_executor(), first, last);
 }
 
-template <class It1, class It2>
-alg::_ifAnyNotRAIt<std::pair<It1, It2>, It1, It2> mismatch_any(It1 first1, const It1 & last1, It2 first2)
+template <class It>
+It adjacent_find_any(alg::executor & ex, const It & first, const It & last)
 {
-    std::atomic<alg::_pair<It1, It2>> result(alg::_make_pair(last1, first2));
-    std::thread * beg = alg::_threads;
-    std::thread * end = alg::_threads + alg::_num_of_threads;
-    for (;beg != end; ++beg, ++first1, ++first2)
-    {
-        *beg = std::thread(alg::_inThreadAnyMismatch<It1, It2>, first1, std::cref(last1), first2, std::cref(last1), std::ref(result));
-    }
-    alg::_joinAllThreads();
-    return alg::_to_std_pair(static_cast<alg::_pair<It1, It2>>(result));
+    alg::_CallScope scope("adjacent_find_any");
+    return alg::_findMatch<false>(ex, first, last, 2, [](const It & begin, const It & end) { return std::adjacent_find(begin, end); });
 }
 
-template <class It1, class It2>
-bool equal(It1 first1, const It1 & last1, It2 first2)
+template <class It>
+It adjacent_find_any(const It & first, const It & last)
 {
-    std::pair<It1, It2> check = alg::mismatch_any(first1, last1, first2);
-    return check.first == last1;
+    return alg::adjacent_find_any(alg::default_executor(), first, last);
 }
 
-template <class InputIt, class OutputIt, class Func>
-alg::_ifAllRAIt<void, InputIt, OutputIt> transform(InputIt first1, const InputIt & last1, OutputIt first2, const Func & f)
+// A pattern for alg::search and alg::search_any whose Boyer-Moore-Horspool table is built once and read by
+// every block. The searched range has to be random access. It pays off for bytes and long patterns; for other
+// element types the table is a hash map and a plain search is usually faster.
+template <class PatternIt, class Hash = std::hash<typename std::iterator_traits<PatternIt>::value_type>, class Pred = std::equal_to<>>
+class boyer_moore_horspool_searcher
+{
+private:
+    std::boyer_moore_horspool_searcher<PatternIt, Hash, Pred> searcher;
+    size_t length;
+public:
+    boyer_moore_horspool_searcher(PatternIt pat_first, PatternIt pat_last, Hash hf = Hash(), Pred pred = Pred());
+
+    size_t size() const { return length; }
+    template <class It>
+    It operator()(const It & first, const It & last) const { return searcher(first, last).first; }
+};
+
+template <class PatternIt, class Hash, class Pred>
+alg::boyer_moore_horspool_searcher<PatternIt, Hash, Pred>::boyer_moore_horspool_searcher(PatternIt pat_first, PatternIt pat_last, Hash hf, Pred pred)
+    : searcher(pat_first, pat_last, std::move(hf), std::move(pred)), length(std::distance(pat_first, pat_last))
 {
-    size_t * splited = alg::_splitSize(last1 - first1);
-    for (uint8_t i = 0; i < alg::_num_of_threads; first1 += splited[i], first2 += splited[i], ++i)
-    {
-        alg::_threads[i] = std::thread(std::transform<InputIt, OutputIt, Func>, first1, first1 + splited[i], first2, f);
-    }
-    alg::_joinAllThreads();
-    delete [] splited;
 }
 
-template <class InputIt, class OutputIt, class Func>
-alg::_ifAnyNotRAIt<void, InputIt, OutputIt> transform(InputIt first1, const InputIt & last1, OutputIt first2, const Func & f)
+template <bool ordered, class It, class PatternIt>
+It _search(alg::executor & ex, const It & first, const It & last, const PatternIt & s_first, const PatternIt & s_last)
 {
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++first1, ++first2, ++i)
+    if (s_first == s_last)
+        return first;
+    return alg::_findMatch<ordered>(ex, first, last, std::distance(s_first, s_last), [&](const It & begin, const It & end)
     {
-        alg::_threads[i] = std::thread(std::transform<alg::_IteratorWrapper<InputIt>, alg::_IteratorWrapper<OutputIt>, Func>,
-                                  alg::_IteratorWrapper<InputIt>(first1, last1),
-                                  alg::_IteratorWrapper<InputIt>(last1),
-                                  alg::_IteratorWrapper<OutputIt>(first2), f);
-    }
-    alg::_joinAllThreads();
+        return std::search(begin, end, s_first, s_last);
+    });
 }
 
-template <class InputIt1, class InputIt2, class OutputIt, class Func>
-alg::_ifAllRAIt<void, InputIt1, InputIt2, OutputIt> transform(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, OutputIt first3, const Func & f)
+template <bool ordered, class It, class PatternIt, class Hash, class Pred>
+It _search(alg::executor & ex, const It & first, const It & last, const alg::boyer_moore_horspool_searcher<PatternIt, Hash, Pred> & searcher)
 {
-    size_t * splited = alg::_splitSize(last1 - first1);
-    for (uint8_t i = 0; i < alg::_num_of_threads; first1 += splited[i], first2 += splited[i], first3 += splited[i], ++i)
-    {
-        alg::_threads[i] = std::thread(std::transform<InputIt1, InputIt2, OutputIt, Func>, first1, first1 + splited[i], first2, first3, f);
-    }
-    alg::_joinAllThreads();
-    delete [] splited;
+    if (searcher.size() == 0)
+        return first;
+    return alg::_findMatch<ordered>(ex, first, last, searcher.size(), searcher);
 }
 
-template <class InputIt1, class InputIt2, class OutputIt, class Func>
-alg::_ifAnyNotRAIt<void, InputIt1, InputIt2, OutputIt> transform(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, OutputIt first3, const Func & f)
+template <class It, class PatternIt>
+It search(alg::executor & ex, const It & first, const It & last, const PatternIt & s_first, const PatternIt & s_last)
 {
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++first1, ++first2, ++first3, ++i)
-    {
-        alg::_threads[i] = std::thread(std::transform<alg::_IteratorWrapper<InputIt1>, alg::_IteratorWrapper<InputIt2>, alg::_IteratorWrapper<OutputIt>, Func>,
-                                  alg::_IteratorWrapper<InputIt1>(first1, last1),
-                                  alg::_IteratorWrapper<InputIt1>(last1),
-                                  alg::_IteratorWrapper<InputIt2>(first2),
-                                  alg::_IteratorWrapper<OutputIt>(first3),  f);
-    }
-    alg::_joinAllThreads();
+    alg::_CallScope scope("search");
+    return alg::_search<true>(ex, first, last, s_first, s_last);
 }
 
-template <class InputIt, class OutputIt, class Func>
-void _oneThreadTransformN(InputIt first1, size_t n, OutputIt first2, const Func & f)
+template <class It, class PatternIt>
+It search(const It & first, const It & last, const PatternIt & s_first, const PatternIt & s_last)
 {
-    for (size_t i = 0; i < n; ++i, ++first1, ++first2)
-        *first2 = f(*first1);
+    return alg::search(alg::default_executor(), first, last, s_first, s_last);
 }
 
-template <class InputIt1, class InputIt2, class OutputIt, class Func>
-void _oneThreadTransformN(InputIt1 first1, size_t n, InputIt2 first2, OutputIt first3, const Func & f)
+template <class It, class PatternIt, class Hash, class Pred>
+It search(alg::executor & ex, const It & first, const It & last, const alg::boyer_moore_horspool_searcher<PatternIt, Hash, Pred> & searcher)
 {
-    for (size_t i = 0; i < n; ++i, ++first1, ++first2, ++first3)
-        *first3 = f(*first1, *first2);
+    alg::_CallScope scope("search");
+    return alg::_search<true>(ex, first, last, searcher);
 }
 
-template <class InputIt, class OutputIt, class Func>
-alg::_ifAllRAIt<void, InputIt, OutputIt> transform_n(InputIt first1, size_t n, OutputIt first2, const Func & f)
+template <class It, class PatternIt, class Hash, class Pred>
+It search(const It & first, const It & last, const alg::boyer_moore_horspool_searcher<PatternIt, Hash, Pred> & searcher)
 {
-    size_t * splited = alg::_splitSize(n);
-    for (uint8_t i = 0; i < alg::_num_of_threads; first1 += splited[i], first2 += splited[i], ++i)
-    {
-        alg::_threads[i] = std::thread(alg::_oneThreadTransformN<InputIt, OutputIt, Func>, first1, splited[i], first2, std::cref(f));
-    }
-    alg::_joinAllThreads();
-    delete [] splited;
+    return alg::search(alg::default_executor(), first, last, searcher);
 }
 
-template <class InputIt, class OutputIt, class Func>
-alg::_ifAnyNotRAIt<void, InputIt, OutputIt> transform_n(InputIt first1, size_t n, OutputIt first2, const Func & f)
+template <class It, class PatternIt>
+It search_any(alg::executor & ex, const It & first, const It & last, const PatternIt & s_first, const PatternIt & s_last)
 {
-    size_t * splited = alg::_splitSize(n);
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++first1, ++first2, ++i)
-    {
-        alg::_threads[i] = std::thread(alg::_oneThreadTransformN<alg::_IteratorWrapper<InputIt>, alg::_IteratorWrapper<OutputIt>, Func>,
-                                  alg::_IteratorWrapper<InputIt>(first1),
-                                  splited[i],
-                                  alg::_IteratorWrapper<OutputIt>(first2), std::cref(f));
-    }
-    alg::_joinAllThreads();
-    delete [] splited;
+    alg::_CallScope scope("search_any");
+    return alg::_search<false>(ex, first, last, s_first, s_last);
 }
 
-template <class InputIt1, class InputIt2, class OutputIt, class Func>
-alg::_ifAllRAIt<void, InputIt1, InputIt2, OutputIt> transform_n(InputIt1 first1, size_t n, InputIt2 first2, OutputIt first3, const Func & f)
+template <class It, class PatternIt>
+It search_any(const It & first, const It & last, const PatternIt & s_first, const PatternIt & s_last)
 {
-    size_t * splited = alg::_splitSize(n);
-    for (uint8_t i = 0; i < alg::_num_of_threads; first1 += splited[i], first2 += splited[i], first3 += splited[i], ++i)
-    {
-        alg::_threads[i] = std::thread(alg::_oneThreadTransformN<InputIt1, InputIt2, OutputIt, Func>, first1, splited[i], first2, first3, std::cref(f));
-    }
-    alg::_joinAllThreads();
-    delete [] splited;
+    return alg::search_any(alg::default_executor(), first, last, s_first, s_last);
 }
 
-template <class InputIt1, class InputIt2, class OutputIt, class Func>
-alg::_ifAnyNotRAIt<void, InputIt1, InputIt2, OutputIt> transform_n(InputIt1 first1, size_t n, InputIt2 first2, OutputIt first3, const Func & f)
+template <class It, class PatternIt, class Hash, class Pred>
+It search_any(alg::executor & ex, const It & first, const It & last, const alg::boyer_moore_horspool_searcher<PatternIt, Hash, Pred> & searcher)
 {
-    size_t * splited = alg::_splitSize(n);
-    for (uint8_t i = 0; i < alg::_num_of_threads; ++first1, ++first2, ++first3, ++i)
-    {
-        alg::_threads[i] = std::thread(alg::_oneThreadTransformN<alg::_IteratorWrapper<InputIt1>, alg::_IteratorWrapper<InputIt2>, alg::_IteratorWrapper<OutputIt>, Func>,
-                                  alg::_IteratorWrapper<InputIt1>(first1),
-                                  splited[i],
-                                  alg::_IteratorWrapper<InputIt2>(first2),
-                                  alg::_IteratorWrapper<OutputIt>(first3), std::cref(f));
-    }
-    alg::_joinAllThreads();
-    delete [] splited;
+    alg::_CallScope scope("search_any");
+    return alg::_search<false>(ex, first, last, searcher);
 }
 
-template <class InputIt, class OutputIt>
-void copy(InputIt first1, const InputIt & last1, OutputIt first2)
+template <class It, class PatternIt, class Hash, class Pred>
+It search_any(const It & first, const It & last, const alg::boyer_moore_horspool_searcher<PatternIt, Hash, Pred> & searcher)
 {
-    alg::transform(first1, last1, first2, [](const auto & item) { return item; });
+    return alg::search_any(alg::default_executor(), first, last, searcher);
 }
 
-template <class InputIt, class OutputIt>
-void copy_n(InputIt first1, size_t n, OutputIt first2)
+template <bool ordered, class It, class Size, class T>
+It _searchN(alg::executor & ex, const It & first, const It & last, Size count, const T & item)
 {
-    alg::transform_n(first1, n, first2, [](const auto & item) { return item; });
+    if (count <= 0)
+        return first;
+    return alg::_findMatch<ordered>(ex, first, last, count, [&](const It & begin, const It & end)
+    {
+        return std::search_n(begin, end, count, item);
+    });
 }
 
-template <class InputIt, class OutputIt>
-void copy_backward(InputIt first1, const InputIt & last1, OutputIt last2)
+template <class It, class Size, class T>
+It search_n(alg::executor & ex, const It & first, const It & last, Size count, const T & item)
 {
-    alg::transform(std::make_reverse_iterator(last1), std::make_reverse_iterator(first1), std::make_reverse_iterator(last2), [](const auto & item) { return item; });
+    alg::_CallScope scope("search_n");
+    return alg::_searchN<true>(ex, first, last, count, item);
 }
 
-template <class InputIt, class OutputIt>
-void move(InputIt first1, const InputIt & last1, OutputIt first2)
+template <class It, class Size, class T>
+It search_n(const It & first, const It & last, Size count, const T & item)
 {
-    alg::transform(first1, last1, first2, [](const auto & item) { return std::move(item); });
+    return alg::search_n(alg::default_executor(), first, last, count, item);
 }
 
-template <class InputIt, class OutputIt>
-void move_backward(InputIt first1, const InputIt & last1, OutputIt last2)
+template <class It, class Size, class T>
+It search_n_any(alg::executor & ex, const It & first, const It & last, Size count, const T & item)
 {
-    alg::transform(first1, last1, std::make_reverse_iterator(last2), [](const auto & item) { return std::move(item); });
+    alg::_CallScope scope("search_n_any");
+    return alg::_searchN<false>(ex, first, last, count, item);
 }
 
-template <class It, typename T>
-void fill(It first, const It & last, const T & item)
+template <class It, class Size, class T>
+It search_n_any(const It & first, const It & last, Size count, const T & item)
 {
-    alg::transform(first, last, first, [&item](const auto &) { return item; });
+    return alg::search_n_any(alg::default_executor(), first, last, count, item);
 }
 
-template <class It, typename T>
-void fill_n(It first, size_t n, const T & item)
+template <class It, class Func>
+bool all_of(alg::executor & ex, const It & first, const It & last, const Func & f)
 {
-    alg::transform_n(first, n, first, [&item](const auto &) { return item; });
+    alg::_CallScope scope("all_of");
+    It check = alg::find_any_if(ex, first, last, std::not_fn(f));
+    return check == last;
 }
 
 template <class It, class Func>
-void generate(It first, const It & last, const Func & f)
+bool all_of(const It & first, const It & last, const Func & f)
 {
-    alg::transform(first, last, first, [&f](const auto &) { return f(); });
+    return alg::all_of(alg::default_executor(), first, last, f);
 }
 
 template <class It, class Func>
-void generate_n(It first, size_t n, const Func & f)
+bool any_of(alg::executor & ex, const It & first, const It & last, const Func & f)
 {
-    alg::transform_n(first, n, first, [&f](const auto &) { return f(); });
+    alg::_CallScope scope("any_of");
+    It check = alg::find_any_if(ex, first, last, f);
+    return check != last;
 }
 
-template <class InputIt, class OutputIt>
-void reverce_copy(InputIt first1, const InputIt & last1, OutputIt first2)
+template <class It, class Func>
+bool any_of(const It & first, const It & last, const Func & f)
 {
-    alg::transform(std::make_reverse_iterator(last1), std::make_reverse_iterator(first1), first2, [](const auto & item) { return item;});
+    return alg::any_of(alg::default_executor(), first, last, f);
 }
 
-template <class InputIt, class OutputIt, class Func, typename T>
-void replace_copy_if(InputIt first1, const InputIt & last1, OutputIt first2, const Func & f, const T & new_value)
+template <class It, class Func>
+bool none_of(alg::executor & ex, const It & first, const It & last, const Func & f)
 {
-    alg::transform(first1, last1, first2, [&f, &new_value](const auto & item) { return f(item) ? new_value : item; });
+    alg::_CallScope scope("none_of");
+    It check = alg::find_any_if(ex, first, last, f);
+    return check == last;
 }
 
-template <class InputIt, class OutputIt, typename T>
-void replace_copy(InputIt first1, const InputIt & last1, OutputIt first2, const T & old_value, const T & new_value)
+template <class It, class Func>
+bool none_of(const It & first, const It & last, const Func & f)
 {
-    alg::transform(first1, last1, first2, [&old_value, &new_value](const auto & item) { return (item == old_value) ? new_value : item; });
+    return alg::none_of(alg::default_executor(), first, last, f);
 }
 
-template <class It, class Func, typename T>
-void replace_if(It first1, const It & last1, const Func & f, const T & new_value)
+template <class It, class Func>
+alg::_ifRAIt<It, Func> for_each(alg::executor & ex, It first, const It & last, const Func & f)
 {
-    alg::for_each(first1, last1, [&f, &new_value](auto & item) { if (f(item)) item = new_value; });
+    alg::_CallScope scope("for_each");
+    alg::_stealingFor(ex, last - first, [&](size_t, size_t begin, size_t end)
+    {
+        std::for_each(first + begin, first + end, f);
+    });
+    return std::move(f);
 }
 
-template <class It, typename T>
-void replace(It first1, const It & last1, const T & old_value, const T & new_value)
+template <class It, class Func>
+alg::_ifnotRAIt<It, Func> for_each(alg::executor & ex, It first, const It & last, const Func & f)
 {
-    alg::for_each(first1, last1, [&old_value, &new_value](auto & item) { if (item == old_value) item = new_value; });
+    alg::_CallScope scope("for_each");
+    if constexpr (alg::_isInputOnly<It>::value)
+    {
+        alg::stream_for_each(ex, first, last, f);
+    }
+    else
+    {
+        alg::_Scratch<It> splited = alg::_split(first, last, ex.concurrency());
+        ex.run(ex.concurrency(), [&](size_t i)
+        {
+            std::for_each(splited[i], splited[i + 1], f);
+        });
+    }
+    return std::move(f);
 }
 
-template <class It1, class It2, class Func>
-void _zipForEach(It1 first1, const It1 & last1, It2 first2, const Func & f)
+template <class It, class Func>
+Func for_each(It first, const It & last, const Func & f)
 {
-    for (;first1 != last1; ++first1, ++first2)
-        f(*first1, *first2);
+    return alg::for_each(alg::default_executor(), first, last, f);
 }
 
-template <class It1, class It2, class Func>
-alg::_ifAllRAIt<void, It1, It2> zip_for_each(It1 first1, const It1 & last1, It2 first2, const Func & f)
+template <class It, class T, class ReduceFunc, class TransformFunc>
+alg::_ifRAIt<It, T> transform_reduce(alg::executor & ex, It first, const It & last, T init, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    alg::_CallScope scope("transform_reduce");
+    alg::_Scratch<alg::_ReduceSlot<T>> slots(ex.concurrency());
+    alg::_stealingFor(ex, last - first, [&](size_t part, size_t begin, size_t end)
+    {
+        alg::_inThreadTransformReduce(slots[part], first + begin, first + end, reduceF, transformF);
+    });
+    T res = alg::_reduceSlots(slots.get(), ex.concurrency(), std::move(init), reduceF);
+    return res;
+}
+
+template <class It, class T, class ReduceFunc, class TransformFunc>
+alg::_ifnotRAIt<It, T> transform_reduce(alg::executor & ex, It first, const It & last, T init, const ReduceFunc & reduceF, const TransformFunc & transformF)
 {
-    size_t * splited = alg::_splitSize(last1 - first1);
-    for (uint8_t i = 0; i < _num_of_threads; first1 += splited[i], first2 += splited[i], ++i)
+    alg::_CallScope scope("transform_reduce");
+    alg::_Scratch<alg::_ReduceSlot<T>> slots(ex.concurrency());
+    if constexpr (alg::_isInputOnly<It>::value)
+    {
+        using V = typename std::iterator_traits<It>::value_type;
+        alg::_IteratorSource<It> source{first, last};
+        alg::_stream<false, V>(ex, source, [&](size_t part, size_t, std::vector<V> & items)
+        {
+            alg::_inThreadTransformReduce(slots[part], items.begin(), items.end(), reduceF, transformF);
+        }, nullptr);
+    }
+    else
     {
-        alg::_threads[i] = std::thread(alg::_zipForEach<It1, It2, Func>, first1, first1 + splited[i], first2, std::cref(f));
+        alg::_Scratch<It> splited = alg::_split(first, last, ex.concurrency());
+        ex.run(ex.concurrency(), [&](size_t i)
+        {
+            alg::_inThreadTransformReduce(slots[i], splited[i], splited[i + 1], reduceF, transformF);
+        });
     }
-    _joinAllThreads();
-    delete[] splited;
+    T res = alg::_reduceSlots(slots.get(), ex.concurrency(), std::move(init), reduceF);
+    return res;
 }
 
-template <class It1, class It2, class Func>
-alg::_ifAnyNotRAIt<void, It1, It2> zip_for_each(It1 first1, const It1 & last1, It2 first2, const Func & f)
+template <class It, class T, class ReduceFunc, class TransformFunc>
+T transform_reduce(It first, const It & last, T init, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    return alg::transform_reduce(alg::default_executor(), first, last, std::move(init), reduceF, transformF);
+}
+
+template <class It1, class It2, class T, class ReduceFunc, class TransformFunc>
+alg::_ifAllRAIt<T, It1, It2> transform_reduce(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, T init,
+                                              const ReduceFunc & reduceF, const TransformFunc & transformF)
 {
-    std::thread * beg = alg::_threads;
-    std::thread * end = alg::_threads + alg::_num_of_threads;
-    for (; beg != end; ++first1, ++first2, ++beg)
+    alg::_CallScope scope("transform_reduce");
+    alg::_Scratch<alg::_ReduceSlot<T>> slots(ex.concurrency());
+    alg::_stealingFor(ex, last1 - first1, [&](size_t part, size_t begin, size_t end)
     {
-        *beg = std::thread(alg::_zipForEach<alg::_IteratorWrapper<It1>, alg::_IteratorWrapper<It2>, Func>,
-                           alg::_IteratorWrapper<It1>(first1, last1),
-                           alg::_IteratorWrapper<It1>(last1),
-                           alg::_IteratorWrapper<It2>(first2), std::cref(f));
+        alg::_inThreadTransformReduce(slots[part], first1 + begin, first1 + end, first2 + begin, reduceF, transformF);
+    });
+    T res = alg::_reduceSlots(slots.get(), ex.concurrency(), std::move(init), reduceF);
+    return res;
+}
+
+template <class It1, class It2, class T, class ReduceFunc, class TransformFunc>
+alg::_ifAnyNotRAIt<T, It1, It2> transform_reduce(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, T init,
+                                                 const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    alg::_CallScope scope("transform_reduce");
+    // Two ranges cannot share one stream, so a single-pass one is read serially.
+    if constexpr (alg::_isInputOnly<It1>::value || alg::_isInputOnly<It2>::value)
+    {
+        for (; first1 != last1; ++first1, ++first2)
+            init = reduceF(std::move(init), transformF(*first1, *first2));
+        return init;
+    }
+    else
+    {
+        alg::_Scratch<std::tuple<It1, It2>> splited = alg::_splitTogether(ex.concurrency(), first1, last1, first2);
+        alg::_Scratch<alg::_ReduceSlot<T>> slots(ex.concurrency());
+        ex.run(ex.concurrency(), [&](size_t i)
+        {
+            alg::_inThreadTransformReduce(slots[i], std::get<0>(splited[i]), std::get<0>(splited[i + 1]), std::get<1>(splited[i]), reduceF, transformF);
+        });
+        T res = alg::_reduceSlots(slots.get(), ex.concurrency(), std::move(init), reduceF);
+        return res;
     }
-    _joinAllThreads();
+}
+
+template <class It1, class It2, class T, class ReduceFunc, class TransformFunc>
+T transform_reduce(It1 first1, const It1 & last1, It2 first2, T init, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    return alg::transform_reduce(alg::default_executor(), first1, last1, first2, std::move(init), reduceF, transformF);
+}
+
+template <class It1, class It2, class T>
+T transform_reduce(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, T init)
+{
+    alg::_CallScope scope("transform_reduce");
+    return alg::transform_reduce(ex, first1, last1, first2, std::move(init), std::plus<>(), std::multiplies<>());
+}
+
+template <class It1, class It2, class T>
+T transform_reduce(It1 first1, const It1 & last1, It2 first2, T init)
+{
+    return alg::transform_reduce(alg::default_executor(), first1, last1, first2, std::move(init));
+}
+
+template <class It, class T, class Func>
+T reduce(alg::executor & ex, It first, const It & last, T init, const Func & f)
+{
+    alg::_CallScope scope("reduce");
+    return alg::transform_reduce(ex, first, last, std::move(init), f, [](const auto & item) { return item; });
+}
+
+template <class It, class T, class Func>
+T reduce(It first, const It & last, T init, const Func & f)
+{
+    return alg::reduce(alg::default_executor(), first, last, std::move(init), f);
+}
+
+template <class It, class T>
+T reduce(alg::executor & ex, It first, const It & last, T init)
+{
+    alg::_CallScope scope("reduce");
+    return alg::reduce(ex, first, last, std::move(init), std::plus<>());
+}
+
+template <class It, class T>
+T reduce(It first, const It & last, T init)
+{
+    return alg::reduce(alg::default_executor(), first, last, std::move(init));
+}
+
+template <class It>
+typename std::iterator_traits<It>::value_type reduce(alg::executor & ex, It first, const It & last)
+{
+    alg::_CallScope scope("reduce");
+    return alg::reduce(ex, first, last, typename std::iterator_traits<It>::value_type());
+}
+
+template <class It>
+typename std::iterator_traits<It>::value_type reduce(It first, const It & last)
+{
+    return alg::reduce(alg::default_executor(), first, last);
+}
+
+// Folds f(partial, item) over a chunk, starting from its first element converted to T.
+template <class T, class It, class Func>
+void _inThreadAccumulate(alg::_ReduceSlot<T> & slot, It first, const It & last, const Func & f)
+{
+    if (first == last)
+        return;
+    T partial = *first;
+    for (++first; first != last; ++first)
+        partial = f(std::move(partial), *first);
+    alg::_mergeIntoSlot(slot, std::move(partial), f);
+}
+
+// Unlike reduce, partial results are combined in the order of the chunks, so f only has to be associative.
+// Every chunk is folded with f(T, item) from its first element converted to T, and the partials are then
+// combined with f(T, T). An f that cannot take two partials, or elements that do not convert to T, such as
+// f(size_t, const std::string &) summing lengths, fold serially as std::accumulate does.
+template <class It, class T, class Func>
+T accumulate(alg::executor & ex, It first, const It & last, T init, const Func & f)
+{
+    alg::_CallScope scope("accumulate");
+    using V = typename std::iterator_traits<It>::value_type;
+    // The stream hands batches out in any order, so a single-pass range is folded serially.
+    if constexpr (std::disjunction<alg::_isInputOnly<It>, std::negation<std::is_convertible<V, T>>,
+                                   std::negation<std::is_invocable_r<T, const Func &, T, T>>>::value)
+        return std::accumulate(first, last, std::move(init), f);
+    else
+    {
+        size_t parts = alg::_partsFor(ex, first, last);
+        alg::_Scratch<It> splited = alg::_split(first, last, parts);
+        alg::_Scratch<alg::_ReduceSlot<T>> slots(parts);
+        ex.run_owned(parts, [&](size_t i)
+        {
+            alg::_inThreadAccumulate(slots[i], splited[i], splited[i + 1], f);
+            alg::_countRange(splited[i], splited[i + 1]);
+        });
+        T res = alg::_reduceSlots(slots.get(), parts, std::move(init), f);
+        return res;
+    }
+}
+
+template <class It, class T, class Func>
+T accumulate(It first, const It & last, T init, const Func & f)
+{
+    return alg::accumulate(alg::default_executor(), first, last, std::move(init), f);
+}
+
+template <class It, class T>
+T accumulate(alg::executor & ex, It first, const It & last, T init)
+{
+    alg::_CallScope scope("accumulate");
+    return alg::accumulate(ex, first, last, std::move(init), std::plus<>());
+}
+
+template <class It, class T>
+T accumulate(It first, const It & last, T init)
+{
+    return alg::accumulate(alg::default_executor(), first, last, std::move(init));
+}
+
+template <class It, class Func>
+typename std::iterator_traits<It>::difference_type count_if(alg::executor & ex, It first, const It & last, const Func & f)
+{
+    alg::_CallScope scope("count_if");
+    using Diff = typename std::iterator_traits<It>::difference_type;
+    if constexpr (alg::_isInputOnly<It>::value)
+        return alg::stream_count_if(ex, first, last, f);
+    else
+        return alg::transform_reduce(ex, first, last, Diff(0), std::plus<>(), [&f](const auto & item) -> Diff { return f(item) ? 1 : 0; });
+}
+
+template <class It, class Func>
+typename std::iterator_traits<It>::difference_type count_if(It first, const It & last, const Func & f)
+{
+    return alg::count_if(alg::default_executor(), first, last, f);
+}
+
+template <class It, class T>
+typename std::iterator_traits<It>::difference_type count(alg::executor & ex, It first, const It & last, const T & item)
+{
+    alg::_CallScope scope("count");
+    using V = typename std::iterator_traits<It>::value_type;
+    using Diff = typename std::iterator_traits<It>::difference_type;
+    if constexpr (alg::_isSimdRange<It>::value)
+    {
+        V value;
+        if ((first != last) && alg::_simdValue(item, value))
+        {
+            const V * data = alg::_toPointer(first);
+            alg::_Scratch<alg::_ReduceSlot<Diff>> slots(ex.concurrency());
+            alg::_stealingFor(ex, last - first, [&](size_t part, size_t begin, size_t end)
+            {
+                alg::_mergeIntoSlot(slots[part], static_cast<Diff>(alg::_simdCount(data + begin, end - begin, value)), std::plus<>());
+            });
+            Diff res = alg::_reduceSlots(slots.get(), ex.concurrency(), Diff(0), std::plus<>());
+            return res;
+        }
+    }
+    return alg::count_if(ex, first, last, alg::_EqualTo<T>{item});
+}
+
+template <class It, class T>
+typename std::iterator_traits<It>::difference_type count(It first, const It & last, const T & item)
+{
+    return alg::count(alg::default_executor(), first, last, item);
+}
+
+// Counters of one part, padded to whole cache lines so that parts never share one.
+struct alignas(alg::_cache_line_size) _CounterLine
+{
+    size_t counts[alg::_cache_line_size / sizeof(size_t)];
+};
+
+// res[b] is the number of elements with binOf(item) == b; elements mapped outside [0, bins) are not counted.
+// A single-pass range is read through the stream ring, every participant counting the batches it takes.
+template <class It, class BinFunc>
+std::vector<size_t> histogram(alg::executor & ex, It first, const It & last, size_t bins, const BinFunc & binOf)
+{
+    alg::_CallScope scope("histogram");
+    constexpr size_t perLine = alg::_cache_line_size / sizeof(size_t);
+    size_t lines = (bins + perLine - 1) / perLine;
+    size_t parts = alg::_isInputOnly<It>::value ? ex.concurrency() : alg::_partsFor(ex, first, last);
+    alg::_Scratch<alg::_CounterLine> tables(std::max<size_t>(1, parts * lines));
+    auto clear = [&](size_t i)
+    {
+        for (size_t line = 0; line < lines; ++line)
+            std::fill(std::begin(tables[i * lines + line].counts), std::end(tables[i * lines + line].counts), 0);
+    };
+    auto countInto = [&](size_t i, auto it, const auto & end)
+    {
+        alg::_CounterLine * own = tables.get() + i * lines;
+        for (; it != end; ++it)
+        {
+            size_t bin = static_cast<size_t>(binOf(*it));
+            if (bin < bins)
+                ++own[bin / perLine].counts[bin % perLine];
+        }
+    };
+    if constexpr (alg::_isInputOnly<It>::value)
+    {
+        using V = typename std::iterator_traits<It>::value_type;
+        for (size_t i = 0; i < parts; ++i)
+            clear(i);
+        alg::_IteratorSource<It> source{first, last};
+        alg::_stream<false, V>(ex, source, [&](size_t part, size_t, std::vector<V> & items)
+        {
+            countInto(part, items.begin(), items.end());
+        }, nullptr);
+    }
+    else
+    {
+        alg::_Scratch<It> splited = alg::_split(first, last, parts);
+        ex.run_owned(parts, [&](size_t i)
+        {
+            clear(i);
+            countInto(i, splited[i], splited[i + 1]);
+            alg::_countRange(splited[i], splited[i + 1]);
+        });
+    }
+    std::vector<size_t> res(bins);
+    size_t mergeParts = parts == 1 ? 1 : alg::_partsFor(ex, lines * parts * perLine);
+    ex.run_owned(mergeParts, [&](size_t k)
+    {
+        size_t begin = bins / mergeParts * k + std::min(k, bins % mergeParts);
+        size_t end = bins / mergeParts * (k + 1) + std::min(k + 1, bins % mergeParts);
+        for (size_t i = 0; i < parts; ++i)
+        {
+            const alg::_CounterLine * own = tables.get() + i * lines;
+            for (size_t bin = begin; bin < end; ++bin)
+                res[bin] += own[bin / perLine].counts[bin % perLine];
+        }
+    });
+    return res;
+}
+
+template <class It, class BinFunc>
+std::vector<size_t> histogram(It first, const It & last, size_t bins, const BinFunc & binOf)
+{
+    return alg::histogram(alg::default_executor(), first, last, bins, binOf);
+}
+
+// The elements themselves are the bins.
+template <class It>
+std::vector<size_t> histogram(alg::executor & ex, It first, const It & last, size_t bins)
+{
+    alg::_CallScope scope("histogram");
+    return alg::histogram(ex, first, last, bins, [](const auto & item) { return static_cast<size_t>(item); });
+}
+
+template <class It>
+std::vector<size_t> histogram(It first, const It & last, size_t bins)
+{
+    return alg::histogram(alg::default_executor(), first, last, bins);
+}
+
+// std::hash is the identity for integers, so its bits are mixed before they pick a shard and a slot.
+inline uint64_t _mixHash(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Open addressing with linear probing, kept at most half full. A hash of 0 marks an empty slot. The slots
+// are allocated on the first add and freed by drain, so tables that stay empty cost no allocation.
+template <class Key, class Value>
+class _KeyTable
+{
+private:
+    std::vector<uint64_t> hashes;
+    std::vector<std::optional<std::pair<Key, Value>>> entries;
+    size_t used;
+
+    void grow();
+public:
+    _KeyTable() : used(0) {}
+
+    size_t size() const { return used; }
+    template <class ReduceFunc>
+    void add(uint64_t hash, Key && key, Value && value, const ReduceFunc & reduceF);
+    template <class Func>
+    void drain(const Func & f);
+};
+
+template <class Key, class Value>
+void alg::_KeyTable<Key, Value>::grow()
+{
+    std::vector<uint64_t> oldHashes(hashes.size() * 2, 0);
+    std::vector<std::optional<std::pair<Key, Value>>> oldEntries(entries.size() * 2);
+    oldHashes.swap(hashes);
+    oldEntries.swap(entries);
+    size_t mask = hashes.size() - 1;
+    for (size_t i = 0; i < oldHashes.size(); ++i)
+    {
+        if (oldHashes[i] == 0)
+            continue;
+        size_t slot = oldHashes[i] & mask;
+        while (hashes[slot] != 0)
+            slot = (slot + 1) & mask;
+        hashes[slot] = oldHashes[i];
+        entries[slot] = std::move(oldEntries[i]);
+    }
+}
+
+template <class Key, class Value>
+template <class ReduceFunc>
+void alg::_KeyTable<Key, Value>::add(uint64_t hash, Key && key, Value && value, const ReduceFunc & reduceF)
+{
+    hash |= hash == 0 ? 1 : 0;
+    if (hashes.empty())
+    {
+        hashes.assign(16, 0);
+        entries.resize(16);
+    }
+    size_t mask = hashes.size() - 1;
+    size_t slot = hash & mask;
+    for (; hashes[slot] != 0; slot = (slot + 1) & mask)
+    {
+        if ((hashes[slot] == hash) && (entries[slot]->first == key))
+        {
+            entries[slot]->second = reduceF(std::move(entries[slot]->second), std::move(value));
+            return;
+        }
+    }
+    hashes[slot] = hash;
+    entries[slot].emplace(std::move(key), std::move(value));
+    if (++used * 2 > hashes.size())
+        grow();
+}
+
+// Calls f(hash, key, value) with every entry moved out and leaves the table empty.
+template <class Key, class Value>
+template <class Func>
+void alg::_KeyTable<Key, Value>::drain(const Func & f)
+{
+    for (size_t i = 0; i < hashes.size(); ++i)
+        if (hashes[i] != 0)
+            f(hashes[i], std::move(entries[i]->first), std::move(entries[i]->second));
+    std::vector<uint64_t>().swap(hashes);
+    std::vector<std::optional<std::pair<Key, Value>>>().swap(entries);
+    used = 0;
+}
+
+// Every part adds its chunk to its own tables, one per shard of the hash space, then every shard merges the
+// tables of all parts on its own; a single-pass range is read through the stream ring, every participant
+// adding the batches it takes. Pairs come out in no particular order; Key and Value have to be default
+// constructible, and reduceF associative and commutative.
+template <class It, class KeyFunc, class ValueFunc, class ReduceFunc>
+auto reduce_by_key(alg::executor & ex, It first, const It & last, const KeyFunc & keyF, const ValueFunc & valueF, const ReduceFunc & reduceF)
+{
+    alg::_CallScope scope("reduce_by_key");
+    using Ref = decltype(*first);
+    using Key = typename std::decay<std::invoke_result_t<const KeyFunc &, Ref>>::type;
+    using Value = typename std::decay<std::invoke_result_t<const ValueFunc &, Ref>>::type;
+    using Table = alg::_KeyTable<Key, Value>;
+    size_t parts = alg::_isInputOnly<It>::value ? ex.concurrency() : alg::_partsFor(ex, first, last);
+    size_t shardBits = 0;
+    while ((parts > 1) && ((size_t(1) << shardBits) < 2 * ex.concurrency()))
+        ++shardBits;
+    size_t shards = size_t(1) << shardBits;
+    alg::_Scratch<Table> tables(parts * shards);
+    auto addInto = [&](size_t i, auto it, const auto & end)
+    {
+        Table * own = tables.get() + i * shards;
+        for (; it != end; ++it)
+        {
+            Key key = keyF(*it);
+            uint64_t hash = alg::_mixHash(std::hash<Key>()(key));
+            own[shardBits == 0 ? 0 : hash >> (64 - shardBits)].add(hash, std::move(key), valueF(*it), reduceF);
+        }
+    };
+    if constexpr (alg::_isInputOnly<It>::value)
+    {
+        using V = typename std::iterator_traits<It>::value_type;
+        alg::_IteratorSource<It> source{first, last};
+        alg::_stream<false, V>(ex, source, [&](size_t part, size_t, std::vector<V> & items)
+        {
+            addInto(part, items.begin(), items.end());
+        }, nullptr);
+    }
+    else
+    {
+        alg::_Scratch<It> splited = alg::_split(first, last, parts);
+        ex.run_owned(parts, [&](size_t i)
+        {
+            addInto(i, splited[i], splited[i + 1]);
+            alg::_countRange(splited[i], splited[i + 1]);
+        });
+    }
+    alg::_Scratch<size_t> offsets(shards + 1);
+    offsets[0] = 0;
+    ex.run_owned(shards, [&](size_t k)
+    {
+        Table & merged = tables[k];
+        for (size_t i = 1; i < parts; ++i)
+            tables[i * shards + k].drain([&](uint64_t hash, Key && key, Value && value)
+            {
+                merged.add(hash, std::move(key), std::move(value), reduceF);
+            });
+        offsets[k + 1] = merged.size();
+    });
+    std::partial_sum(offsets.get(), offsets.get() + shards + 1, offsets.get());
+    std::vector<std::pair<Key, Value>> res(offsets[shards]);
+    ex.run_owned(shards, [&](size_t k)
+    {
+        size_t out = offsets[k];
+        tables[k].drain([&](uint64_t, Key && key, Value && value)
+        {
+            res[out].first = std::move(key);
+            res[out].second = std::move(value);
+            ++out;
+        });
+    });
+    return res;
+}
+
+template <class It, class KeyFunc, class ValueFunc, class ReduceFunc>
+auto reduce_by_key(It first, const It & last, const KeyFunc & keyF, const ValueFunc & valueF, const ReduceFunc & reduceF)
+{
+    return alg::reduce_by_key(alg::default_executor(), first, last, keyF, valueF, reduceF);
+}
+
+// Number of elements per distinct keyF(item), in no particular order.
+template <class It, class KeyFunc>
+auto count_by_key(alg::executor & ex, It first, const It & last, const KeyFunc & keyF)
+{
+    alg::_CallScope scope("count_by_key");
+    return alg::reduce_by_key(ex, first, last, keyF, [](const auto &) { return size_t(1); }, std::plus<>());
+}
+
+template <class It, class KeyFunc>
+auto count_by_key(It first, const It & last, const KeyFunc & keyF)
+{
+    return alg::count_by_key(alg::default_executor(), first, last, keyF);
+}
+
+template <class It>
+auto count_by_key(alg::executor & ex, It first, const It & last)
+{
+    alg::_CallScope scope("count_by_key");
+    return alg::count_by_key(ex, first, last, [](const auto & item) { return item; });
+}
+
+template <class It>
+auto count_by_key(It first, const It & last)
+{
+    return alg::count_by_key(alg::default_executor(), first, last);
+}
+
+template <class T, class InputIt, class OutputIt, class ReduceFunc, class TransformFunc>
+void _inThreadInclusiveScan(InputIt first, const InputIt & last, OutputIt d_first, const std::optional<T> & carry,
+                            const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    if (first == last)
+        return;
+    T acc = carry ? reduceF(*carry, transformF(*first)) : T(transformF(*first));
+    *d_first = acc;
+    for (++first, ++d_first; first != last; ++first, ++d_first)
+    {
+        acc = reduceF(std::move(acc), transformF(*first));
+        *d_first = acc;
+    }
+}
+
+template <class T, class InputIt, class OutputIt, class ReduceFunc, class TransformFunc>
+void _inThreadExclusiveScan(InputIt first, const InputIt & last, OutputIt d_first, const std::optional<T> & carry,
+                            const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    if (first == last)
+        return;
+    T acc = *carry;
+    for (; first != last; ++first, ++d_first)
+    {
+        T item = transformF(*first);
+        *d_first = acc;
+        acc = reduceF(std::move(acc), std::move(item));
+    }
+}
+
+// Reduce-then-scan: the first pass reduces every chunk but the last, the carries into the chunks are
+// combined serially, the second pass scans every chunk from its carry. Each element is read before
+// its output is written, so d_first may be first.
+template <bool inclusive, class T, class InputIt, class OutputIt, class ReduceFunc, class TransformFunc>
+OutputIt _scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, std::optional<T> init,
+               const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    size_t parts = alg::_partsFor(ex, first, last);
+    alg::_Scratch<InputIt> splited = alg::_split(first, last, parts);
+    alg::_Scratch<alg::_ReduceSlot<T>> slots(parts);
+    ex.run_owned(parts - 1, [&](size_t i)
+    {
+        alg::_inThreadTransformReduce(slots[i], splited[i], splited[i + 1], reduceF, transformF);
+    });
+    std::optional<T> carry = std::move(init);
+    for (size_t i = 0; i < parts; ++i)
+    {
+        std::optional<T> sum = std::move(slots[i].value);
+        slots[i].value = carry;
+        if (sum)
+            carry = carry ? reduceF(std::move(*carry), std::move(*sum)) : std::move(*sum);
+    }
+    ex.run_owned(parts, [&](size_t i)
+    {
+        alg::_countRange(splited[i], splited[i + 1]);
+        if (inclusive)
+            alg::_inThreadInclusiveScan(splited[i], splited[i + 1], d_first + (splited[i] - first), slots[i].value, reduceF, transformF);
+        else
+            alg::_inThreadExclusiveScan(splited[i], splited[i + 1], d_first + (splited[i] - first), slots[i].value, reduceF, transformF);
+    });
+    return d_first + (last - first);
+}
+
+template <class InputIt, class OutputIt, class ReduceFunc, class TransformFunc, class T>
+alg::_ifAllRAIt<OutputIt, InputIt, OutputIt> transform_inclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first,
+                                                                      const ReduceFunc & reduceF, const TransformFunc & transformF, T init)
+{
+    alg::_CallScope scope("transform_inclusive_scan");
+    return alg::_scan<true>(ex, first, last, d_first, std::optional<T>(std::move(init)), reduceF, transformF);
+}
+
+template <class InputIt, class OutputIt, class ReduceFunc, class TransformFunc, class T>
+OutputIt transform_inclusive_scan(InputIt first, const InputIt & last, OutputIt d_first, const ReduceFunc & reduceF, const TransformFunc & transformF, T init)
+{
+    return alg::transform_inclusive_scan(alg::default_executor(), first, last, d_first, reduceF, transformF, std::move(init));
+}
+
+template <class InputIt, class OutputIt, class ReduceFunc, class TransformFunc>
+alg::_ifAllRAIt<OutputIt, InputIt, OutputIt> transform_inclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first,
+                                                                      const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    alg::_CallScope scope("transform_inclusive_scan");
+    using T = typename std::decay<decltype(transformF(*first))>::type;
+    return alg::_scan<true>(ex, first, last, d_first, std::optional<T>(), reduceF, transformF);
+}
+
+template <class InputIt, class OutputIt, class ReduceFunc, class TransformFunc>
+OutputIt transform_inclusive_scan(InputIt first, const InputIt & last, OutputIt d_first, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    return alg::transform_inclusive_scan(alg::default_executor(), first, last, d_first, reduceF, transformF);
+}
+
+template <class InputIt, class OutputIt, class T, class ReduceFunc, class TransformFunc>
+alg::_ifAllRAIt<OutputIt, InputIt, OutputIt> transform_exclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first,
+                                                                      T init, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    alg::_CallScope scope("transform_exclusive_scan");
+    return alg::_scan<false>(ex, first, last, d_first, std::optional<T>(std::move(init)), reduceF, transformF);
+}
+
+template <class InputIt, class OutputIt, class T, class ReduceFunc, class TransformFunc>
+OutputIt transform_exclusive_scan(InputIt first, const InputIt & last, OutputIt d_first, T init, const ReduceFunc & reduceF, const TransformFunc & transformF)
+{
+    return alg::transform_exclusive_scan(alg::default_executor(), first, last, d_first, std::move(init), reduceF, transformF);
+}
+
+template <class InputIt, class OutputIt, class Func, class T>
+OutputIt inclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, const Func & f, T init)
+{
+    alg::_CallScope scope("inclusive_scan");
+    return alg::transform_inclusive_scan(ex, first, last, d_first, f, [](const auto & item) { return item; }, std::move(init));
+}
+
+template <class InputIt, class OutputIt, class Func, class T>
+OutputIt inclusive_scan(InputIt first, const InputIt & last, OutputIt d_first, const Func & f, T init)
+{
+    return alg::inclusive_scan(alg::default_executor(), first, last, d_first, f, std::move(init));
+}
+
+template <class InputIt, class OutputIt, class Func>
+OutputIt inclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("inclusive_scan");
+    return alg::transform_inclusive_scan(ex, first, last, d_first, f,
+                                         [](const auto & item) -> typename std::iterator_traits<InputIt>::value_type { return item; });
+}
+
+template <class InputIt, class OutputIt, class Func>
+OutputIt inclusive_scan(InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    return alg::inclusive_scan(alg::default_executor(), first, last, d_first, f);
+}
+
+template <class InputIt, class OutputIt>
+OutputIt inclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first)
+{
+    alg::_CallScope scope("inclusive_scan");
+    return alg::inclusive_scan(ex, first, last, d_first, std::plus<>());
+}
+
+template <class InputIt, class OutputIt>
+OutputIt inclusive_scan(InputIt first, const InputIt & last, OutputIt d_first)
+{
+    return alg::inclusive_scan(alg::default_executor(), first, last, d_first);
+}
+
+template <class InputIt, class OutputIt, class T, class Func>
+OutputIt exclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, T init, const Func & f)
+{
+    alg::_CallScope scope("exclusive_scan");
+    return alg::transform_exclusive_scan(ex, first, last, d_first, std::move(init), f, [](const auto & item) { return item; });
+}
+
+template <class InputIt, class OutputIt, class T, class Func>
+OutputIt exclusive_scan(InputIt first, const InputIt & last, OutputIt d_first, T init, const Func & f)
+{
+    return alg::exclusive_scan(alg::default_executor(), first, last, d_first, std::move(init), f);
+}
+
+template <class InputIt, class OutputIt, class T>
+OutputIt exclusive_scan(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, T init)
+{
+    alg::_CallScope scope("exclusive_scan");
+    return alg::exclusive_scan(ex, first, last, d_first, std::move(init), std::plus<>());
+}
+
+template <class InputIt, class OutputIt, class T>
+OutputIt exclusive_scan(InputIt first, const InputIt & last, OutputIt d_first, T init)
+{
+    return alg::exclusive_scan(alg::default_executor(), first, last, d_first, std::move(init));
+}
+
+template <class It1, class It2>
+alg::_ifAllRAIt<alg::_Scratch<std::tuple<It1, It2>>, It1, It2> _splitPair(size_t parts, It1 first1, const It1 & last1, It2 first2)
+{
+    alg::_Scratch<std::tuple<It1, It2>> res(parts + 1);
+    size_t n = last1 - first1;
+    for (size_t i = 0; i <= parts; ++i)
+        res[i] = std::make_tuple(first1 + alg::_chunkBegin(n, parts, i), first2 + alg::_chunkBegin(n, parts, i));
+    return res;
+}
+
+template <class It1, class It2>
+alg::_ifAnyNotRAIt<alg::_Scratch<std::tuple<It1, It2>>, It1, It2> _splitPair(size_t parts, It1 first1, const It1 & last1, It2 first2)
+{
+    return alg::_splitTogether(parts, first1, last1, first2);
+}
+
+template <class It1, class It2>
+bool _inThreadMismatch(It1 & first1, const It1 & last1, It2 & first2)
+{
+    using T = typename std::iterator_traits<It1>::value_type;
+    if constexpr (alg::_isSimdRange<It1>::value && alg::_isSimdRange<It2>::value &&
+                  std::is_same<T, typename std::iterator_traits<It2>::value_type>::value)
+    {
+        if (first1 == last1)
+            return false;
+        size_t n = last1 - first1;
+        size_t i = alg::_simdMismatch(alg::_toPointer(first1), alg::_toPointer(first2), n);
+        first1 += i;
+        first2 += i;
+        return i != n;
+    }
+    for (; first1 != last1; ++first1, ++first2)
+        if (*first1 != *first2)
+            return true;
+    return false;
+}
+
+// Same block scheme as _findIf.
+template <bool ordered, class It1, class It2>
+std::pair<It1, It2> _mismatch(alg::executor & ex, It1 first1, const It1 & last1, It2 first2)
+{
+    size_t blocks = alg::_searchBlocks(ex, first1, last1);
+    alg::_Scratch<std::tuple<It1, It2>> splited = alg::_splitPair(blocks, first1, last1, first2);
+    alg::_Scratch<std::tuple<It1, It2>> found(blocks);
+    std::atomic<size_t> best(blocks);
+    ex.run(blocks, [&](size_t i)
+    {
+        size_t current = best.load(std::memory_order_relaxed);
+        if (ordered ? (i > current) : (current != blocks))
+            return;
+        found[i] = splited[i];
+        bool hit = alg::_inThreadMismatch(std::get<0>(found[i]), std::get<0>(splited[i + 1]), std::get<1>(found[i]));
+        alg::_countRange(std::get<0>(splited[i]), std::get<0>(found[i]));
+        if (hit)
+            alg::_atomicMin(best, i);
+    });
+    std::tuple<It1, It2> & res = best == blocks ? splited[blocks] : found[best];
+    return std::make_pair(std::get<0>(res), std::get<1>(res));
+}
+
+template <class It1, class It2>
+std::pair<It1, It2> mismatch_any(alg::executor & ex, const It1 & first1, const It1 & last1, const It2 & first2)
+{
+    alg::_CallScope scope("mismatch_any");
+    return alg::_mismatch<false>(ex, first1, last1, first2);
+}
+
+template <class It1, class It2>
+std::pair<It1, It2> mismatch_any(It1 first1, const It1 & last1, It2 first2)
+{
+    return alg::mismatch_any(alg::default_executor(), first1, last1, first2);
+}
+
+template <class It1, class It2>
+std::pair<It1, It2> mismatch(alg::executor & ex, const It1 & first1, const It1 & last1, const It2 & first2)
+{
+    alg::_CallScope scope("mismatch");
+    return alg::_mismatch<true>(ex, first1, last1, first2);
+}
+
+template <class It1, class It2>
+std::pair<It1, It2> mismatch(const It1 & first1, const It1 & last1, const It2 & first2)
+{
+    return alg::mismatch(alg::default_executor(), first1, last1, first2);
+}
+
+template <class It1, class It2>
+bool equal(alg::executor & ex, It1 first1, const It1 & last1, It2 first2)
+{
+    alg::_CallScope scope("equal");
+    if constexpr (alg::_isBitwiseComparable<It1, It2>::value)
+    {
+        size_t n = last1 - first1;
+        return (n == 0) || alg::_equalBytes(ex, alg::_toPointer(first1), alg::_toPointer(first2), n * sizeof(*first1));
+    }
+    std::pair<It1, It2> check = alg::mismatch_any(ex, first1, last1, first2);
+    return check.first == last1;
+}
+
+template <class It1, class It2>
+bool equal(It1 first1, const It1 & last1, It2 first2)
+{
+    return alg::equal(alg::default_executor(), first1, last1, first2);
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifAllRAIt<void, InputIt, OutputIt> transform(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt first2, const Func & f)
+{
+    alg::_CallScope scope("transform");
+    alg::_stealingFor(ex, last1 - first1, [&](size_t, size_t begin, size_t end)
+    {
+        std::transform(first1 + begin, first1 + end, first2 + begin, f);
+    });
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifAnyNotRAIt<void, InputIt, OutputIt> transform(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt first2, const Func & f)
+{
+    alg::_CallScope scope("transform");
+    if constexpr (alg::_isInputOnly<InputIt>::value || alg::_isOutputOnly<OutputIt>::value)
+    {
+        alg::stream_transform(ex, first1, last1, first2, f);
+    }
+    else
+    {
+        alg::_Scratch<std::tuple<InputIt, OutputIt>> splited = alg::_splitTogether(ex.concurrency(), first1, last1, first2);
+        ex.run(ex.concurrency(), [&](size_t i)
+        {
+            std::transform(std::get<0>(splited[i]), std::get<0>(splited[i + 1]), std::get<1>(splited[i]), f);
+        });
+    }
+}
+
+template <class InputIt, class OutputIt, class Func>
+void transform(InputIt first1, const InputIt & last1, OutputIt first2, const Func & f)
+{
+    alg::transform(alg::default_executor(), first1, last1, first2, f);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Func>
+alg::_ifAllRAIt<void, InputIt1, InputIt2, OutputIt> transform(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, OutputIt first3, const Func & f)
+{
+    alg::_CallScope scope("transform");
+    alg::_stealingFor(ex, last1 - first1, [&](size_t, size_t begin, size_t end)
+    {
+        std::transform(first1 + begin, first1 + end, first2 + begin, first3 + begin, f);
+    });
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Func>
+alg::_ifAnyNotRAIt<void, InputIt1, InputIt2, OutputIt> transform(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, OutputIt first3, const Func & f)
+{
+    alg::_CallScope scope("transform");
+    // Two ranges cannot share one stream, so single-pass ones and output-only iterators are run serially.
+    if constexpr (alg::_isInputOnly<InputIt1>::value || alg::_isInputOnly<InputIt2>::value || alg::_isOutputOnly<OutputIt>::value)
+        std::transform(first1, last1, first2, first3, f);
+    else
+    {
+        alg::_Scratch<std::tuple<InputIt1, InputIt2, OutputIt>> splited = alg::_splitTogether(ex.concurrency(), first1, last1, first2, first3);
+        ex.run(ex.concurrency(), [&](size_t i)
+        {
+            std::transform(std::get<0>(splited[i]), std::get<0>(splited[i + 1]), std::get<1>(splited[i]), std::get<2>(splited[i]), f);
+        });
+    }
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Func>
+void transform(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, OutputIt first3, const Func & f)
+{
+    alg::transform(alg::default_executor(), first1, last1, first2, first3, f);
+}
+
+template <class InputIt, class OutputIt, class Func>
+void _oneThreadTransformN(InputIt first1, size_t n, OutputIt first2, const Func & f)
+{
+    for (size_t i = 0; i < n; ++i, ++first1, ++first2)
+        *first2 = f(*first1);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Func>
+void _oneThreadTransformN(InputIt1 first1, size_t n, InputIt2 first2, OutputIt first3, const Func & f)
+{
+    for (size_t i = 0; i < n; ++i, ++first1, ++first2, ++first3)
+        *first3 = f(*first1, *first2);
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifAllRAIt<void, InputIt, OutputIt> transform_n(alg::executor & ex, InputIt first1, size_t n, OutputIt first2, const Func & f)
+{
+    alg::_CallScope scope("transform_n");
+    alg::_stealingFor(ex, n, [&](size_t, size_t begin, size_t end)
+    {
+        alg::_oneThreadTransformN(first1 + begin, end - begin, first2 + begin, f);
+    });
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifAnyNotRAIt<void, InputIt, OutputIt> transform_n(alg::executor & ex, InputIt first1, size_t n, OutputIt first2, const Func & f)
+{
+    alg::_CallScope scope("transform_n");
+    // _splitN walks copies of the iterators ahead, which single-pass and output-only ones do not allow.
+    if constexpr (alg::_isInputOnly<InputIt>::value || alg::_isOutputOnly<OutputIt>::value)
+        alg::_oneThreadTransformN(first1, n, first2, f);
+    else
+    {
+        size_t parts = alg::_partsFor(ex, n);
+        alg::_Scratch<std::tuple<InputIt, OutputIt>> splited = alg::_splitN(n, parts, first1, first2);
+        ex.run(parts, [&](size_t i)
+        {
+            size_t size = alg::_chunkBegin(n, parts, i + 1) - alg::_chunkBegin(n, parts, i);
+            alg::_oneThreadTransformN(std::get<0>(splited[i]), size, std::get<1>(splited[i]), f);
+            alg::_countElements(size);
+        });
+    }
+}
+
+template <class InputIt, class OutputIt, class Func>
+void transform_n(InputIt first1, size_t n, OutputIt first2, const Func & f)
+{
+    alg::transform_n(alg::default_executor(), first1, n, first2, f);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Func>
+alg::_ifAllRAIt<void, InputIt1, InputIt2, OutputIt> transform_n(alg::executor & ex, InputIt1 first1, size_t n, InputIt2 first2, OutputIt first3, const Func & f)
+{
+    alg::_CallScope scope("transform_n");
+    alg::_stealingFor(ex, n, [&](size_t, size_t begin, size_t end)
+    {
+        alg::_oneThreadTransformN(first1 + begin, end - begin, first2 + begin, first3 + begin, f);
+    });
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Func>
+alg::_ifAnyNotRAIt<void, InputIt1, InputIt2, OutputIt> transform_n(alg::executor & ex, InputIt1 first1, size_t n, InputIt2 first2, OutputIt first3, const Func & f)
+{
+    alg::_CallScope scope("transform_n");
+    if constexpr (alg::_isInputOnly<InputIt1>::value || alg::_isInputOnly<InputIt2>::value || alg::_isOutputOnly<OutputIt>::value)
+        alg::_oneThreadTransformN(first1, n, first2, first3, f);
+    else
+    {
+        size_t parts = alg::_partsFor(ex, n);
+        alg::_Scratch<std::tuple<InputIt1, InputIt2, OutputIt>> splited = alg::_splitN(n, parts, first1, first2, first3);
+        ex.run(parts, [&](size_t i)
+        {
+            size_t size = alg::_chunkBegin(n, parts, i + 1) - alg::_chunkBegin(n, parts, i);
+            alg::_oneThreadTransformN(std::get<0>(splited[i]), size, std::get<1>(splited[i]), std::get<2>(splited[i]), f);
+            alg::_countElements(size);
+        });
+    }
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Func>
+void transform_n(InputIt1 first1, size_t n, InputIt2 first2, OutputIt first3, const Func & f)
+{
+    alg::transform_n(alg::default_executor(), first1, n, first2, first3, f);
+}
+
+template <class InputIt, class OutputIt>
+void copy(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt first2)
+{
+    alg::_CallScope scope("copy");
+    if constexpr (alg::_isBitwiseCopyable<InputIt, OutputIt>::value)
+    {
+        if (first1 != last1)
+            alg::_copyBytes(ex, alg::_toPointer(first2), alg::_toPointer(first1), (last1 - first1) * sizeof(*first1));
+    }
+    else
+        alg::transform(ex, first1, last1, first2, [](const auto & item) { return item; });
+}
+
+template <class InputIt, class OutputIt>
+void copy(InputIt first1, const InputIt & last1, OutputIt first2)
+{
+    alg::copy(alg::default_executor(), first1, last1, first2);
+}
+
+template <class InputIt, class OutputIt>
+void copy_n(alg::executor & ex, InputIt first1, size_t n, OutputIt first2)
+{
+    alg::_CallScope scope("copy_n");
+    if constexpr (alg::_isBitwiseCopyable<InputIt, OutputIt>::value)
+    {
+        if (n != 0)
+            alg::_copyBytes(ex, alg::_toPointer(first2), alg::_toPointer(first1), n * sizeof(*first1));
+    }
+    else
+        alg::transform_n(ex, first1, n, first2, [](const auto & item) { return item; });
+}
+
+template <class InputIt, class OutputIt>
+void copy_n(InputIt first1, size_t n, OutputIt first2)
+{
+    alg::copy_n(alg::default_executor(), first1, n, first2);
+}
+
+template <class InputIt, class OutputIt>
+void copy_backward(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt last2)
+{
+    alg::_CallScope scope("copy_backward");
+    if constexpr (alg::_isBitwiseCopyable<InputIt, OutputIt>::value)
+    {
+        if (first1 != last1)
+            alg::_copyBytes(ex, alg::_toPointer(last2 - (last1 - first1)), alg::_toPointer(first1), (last1 - first1) * sizeof(*first1));
+    }
+    else
+        alg::transform(ex, std::make_reverse_iterator(last1), std::make_reverse_iterator(first1), std::make_reverse_iterator(last2), [](const auto & item) { return item; });
+}
+
+template <class InputIt, class OutputIt>
+void copy_backward(InputIt first1, const InputIt & last1, OutputIt last2)
+{
+    alg::copy_backward(alg::default_executor(), first1, last1, last2);
+}
+
+template <class InputIt, class OutputIt>
+void move(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt first2)
+{
+    alg::_CallScope scope("move");
+    if constexpr (alg::_isBitwiseCopyable<InputIt, OutputIt>::value)
+        alg::copy(ex, first1, last1, first2);
+    else
+        alg::transform(ex, first1, last1, first2, [](auto && item) { return std::move(item); });
+}
+
+template <class InputIt, class OutputIt>
+void move(InputIt first1, const InputIt & last1, OutputIt first2)
+{
+    alg::move(alg::default_executor(), first1, last1, first2);
+}
+
+template <class InputIt, class OutputIt>
+void move_backward(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt last2)
+{
+    alg::_CallScope scope("move_backward");
+    if constexpr (alg::_isBitwiseCopyable<InputIt, OutputIt>::value)
+        alg::copy_backward(ex, first1, last1, last2);
+    else
+        alg::transform(ex, std::make_reverse_iterator(last1), std::make_reverse_iterator(first1), std::make_reverse_iterator(last2),
+                       [](auto && item) { return std::move(item); });
+}
+
+template <class InputIt, class OutputIt>
+void move_backward(InputIt first1, const InputIt & last1, OutputIt last2)
+{
+    alg::move_backward(alg::default_executor(), first1, last1, last2);
+}
+
+template <class It, typename T>
+void fill(alg::executor & ex, It first, const It & last, const T & item)
+{
+    alg::_CallScope scope("fill");
+    if constexpr (alg::_isBitwiseCopyable<It, It>::value)
+    {
+        if (first != last)
+            alg::_fillValues(ex, alg::_toPointer(first), last - first, static_cast<typename std::iterator_traits<It>::value_type>(item));
+    }
+    else
+        alg::for_each(ex, first, last, [&item](auto && value) { value = item; });
+}
+
+template <class It, typename T>
+void fill(It first, const It & last, const T & item)
+{
+    alg::fill(alg::default_executor(), first, last, item);
+}
+
+template <class It, typename T>
+void fill_n(alg::executor & ex, It first, size_t n, const T & item)
+{
+    alg::_CallScope scope("fill_n");
+    if constexpr (alg::_isBitwiseCopyable<It, It>::value)
+    {
+        if (n != 0)
+            alg::_fillValues(ex, alg::_toPointer(first), n, static_cast<typename std::iterator_traits<It>::value_type>(item));
+    }
+    else if constexpr (std::is_same<typename std::iterator_traits<It>::iterator_category, std::random_access_iterator_tag>::value)
+        alg::for_each(ex, first, first + n, [&item](auto && value) { value = item; });
+    else if constexpr (alg::_isOutputOnly<It>::value)
+        std::fill_n(first, n, item);
+    else
+    {
+        // Assigns without reading the destination, as fill does.
+        size_t parts = alg::_partsFor(ex, n);
+        alg::_Scratch<std::tuple<It>> splited = alg::_splitN(n, parts, first);
+        ex.run(parts, [&](size_t i)
+        {
+            size_t size = alg::_chunkBegin(n, parts, i + 1) - alg::_chunkBegin(n, parts, i);
+            std::fill_n(std::get<0>(splited[i]), size, item);
+            alg::_countElements(size);
+        });
+    }
+}
+
+template <class It, typename T>
+void fill_n(It first, size_t n, const T & item)
+{
+    alg::fill_n(alg::default_executor(), first, n, item);
+}
+
+// Writes every element from the participant that later calls over [first, last) with the same executor
+// give its share to, so that with pinned workers each share is allocated on the node that works on it.
+// Meant for memory nothing has touched yet, such as an alg::first_touch_vector of trivial elements.
+template <class RAIt, typename T>
+void first_touch_fill(alg::executor & ex, RAIt first, const RAIt & last, const T & item)
+{
+    alg::_CallScope scope("first_touch_fill");
+    size_t n = last - first;
+    size_t parts = ex.concurrency();
+    ex.run_owned(parts, [&](size_t i)
+    {
+        RAIt begin = first + (n / parts * i + std::min(i, n % parts));
+        RAIt end = first + (n / parts * (i + 1) + std::min(i + 1, n % parts));
+        std::fill(begin, end, item);
+        alg::_countRange(begin, end);
+    });
+}
+
+template <class RAIt, typename T>
+void first_touch_fill(RAIt first, const RAIt & last, const T & item)
+{
+    alg::first_touch_fill(alg::default_executor(), first, last, item);
+}
+
+template <class It, class Func>
+void generate(alg::executor & ex, It first, const It & last, const Func & f)
+{
+    alg::_CallScope scope("generate");
+    alg::transform(ex, first, last, first, [&f](const auto &) { return f(); });
+}
+
+template <class It, class Func>
+void generate(It first, const It & last, const Func & f)
+{
+    alg::generate(alg::default_executor(), first, last, f);
+}
+
+template <class It, class Func>
+void generate_n(alg::executor & ex, It first, size_t n, const Func & f)
+{
+    alg::_CallScope scope("generate_n");
+    alg::transform_n(ex, first, n, first, [&f](const auto &) { return f(); });
+}
+
+template <class It, class Func>
+void generate_n(It first, size_t n, const Func & f)
+{
+    alg::generate_n(alg::default_executor(), first, n, f);
+}
+
+// The state of participant part, built by init() the first time it is asked for.
+template <class State, class Init>
+State & _stateOf(alg::_Scratch<alg::_ReduceSlot<State>> & states, size_t part, const Init & init)
+{
+    std::optional<State> & state = states[part].value;
+    if (!state)
+        state.emplace(init());
+    return *state;
+}
+
+template <class Init>
+using _stateType = typename std::decay<std::invoke_result_t<const Init &>>::type;
+
+// Calls chunk(state, first, last, others...) over chunks of the n elements from first, others... being the
+// matching positions of the other ranges. Every participant has its own state, built by init() when it
+// gets its first chunk and kept for the rest of the call, so chunk can use it without locking.
+template <class Init, class Chunk, class It, class... Others>
+void _withState(alg::executor & ex, const Init & init, const Chunk & chunk, size_t n, const It & first, Others... others)
+{
+    using State = alg::_stateType<Init>;
+    alg::_Scratch<alg::_ReduceSlot<State>> states(ex.concurrency());
+    if constexpr (all_is_same<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category,
+                              typename std::iterator_traits<Others>::iterator_category...>::value)
+    {
+        alg::_stealingFor(ex, n, [&](size_t part, size_t begin, size_t end)
+        {
+            chunk(alg::_stateOf(states, part, init), first + begin, first + end, (others + begin)...);
+        });
+    }
+    else
+    {
+        size_t parts = alg::_partsFor(ex, n);
+        alg::_Scratch<std::tuple<It, Others...>> splited = alg::_splitN(n, parts, first, others...);
+        ex.run_owned(parts, [&](size_t i)
+        {
+            std::apply([&](const It & from, const Others &... otherFroms)
+            {
+                chunk(alg::_stateOf(states, i, init), from, std::get<0>(splited[i + 1]), otherFroms...);
+            }, splited[i]);
+            alg::_countElements(alg::_chunkBegin(n, parts, i + 1) - alg::_chunkBegin(n, parts, i));
+        });
+    }
+}
+
+// f(state, item) with one state per worker, built by init(); see _withState.
+template <class It, class Init, class Func>
+void for_each_with_state(alg::executor & ex, const It & first, const It & last, const Init & init, const Func & f)
+{
+    alg::_CallScope scope("for_each_with_state");
+    if constexpr (alg::_isInputOnly<It>::value)
+    {
+        using T = typename std::iterator_traits<It>::value_type;
+        alg::_Scratch<alg::_ReduceSlot<alg::_stateType<Init>>> states(ex.concurrency());
+        It current = first;
+        alg::_IteratorSource<It> source{current, last};
+        alg::_stream<false, T>(ex, source, [&](size_t part, size_t, std::vector<T> & items)
+        {
+            auto & state = alg::_stateOf(states, part, init);
+            for (T & item : items)
+                f(state, item);
+        }, nullptr);
+    }
+    else
+    {
+        alg::_withState(ex, init, [&f](auto & state, It from, const It & to)
+        {
+            for (; from != to; ++from)
+                f(state, *from);
+        }, std::distance(first, last), first);
+    }
+}
+
+template <class It, class Init, class Func>
+void for_each_with_state(const It & first, const It & last, const Init & init, const Func & f)
+{
+    alg::for_each_with_state(alg::default_executor(), first, last, init, f);
+}
+
+// Single-pass inputs and output-only destinations, such as std::back_inserter, go through the stream ring
+// as in transform, so the output is written in order.
+template <class InputIt, class OutputIt, class Init, class Func>
+OutputIt transform_with_state(alg::executor & ex, const InputIt & first, const InputIt & last, OutputIt d_first, const Init & init, const Func & f)
+{
+    alg::_CallScope scope("transform_with_state");
+    if constexpr (alg::_isInputOnly<InputIt>::value || alg::_isOutputOnly<OutputIt>::value)
+    {
+        using T = typename std::iterator_traits<InputIt>::value_type;
+        alg::_Scratch<alg::_ReduceSlot<alg::_stateType<Init>>> states(ex.concurrency());
+        InputIt current = first;
+        alg::_IteratorSource<InputIt> source{current, last};
+        return alg::_streamTransformParts<T>(ex, source, d_first, [&](size_t part, T & item)
+        {
+            return f(alg::_stateOf(states, part, init), item);
+        });
+    }
+    else
+    {
+        size_t n = std::distance(first, last);
+        alg::_withState(ex, init, [&f](auto & state, InputIt from, const InputIt & to, OutputIt out)
+        {
+            for (; from != to; ++from, ++out)
+                *out = f(state, *from);
+        }, n, first, d_first);
+        return std::next(d_first, n);
+    }
+}
+
+template <class InputIt, class OutputIt, class Init, class Func>
+OutputIt transform_with_state(const InputIt & first, const InputIt & last, OutputIt d_first, const Init & init, const Func & f)
+{
+    return alg::transform_with_state(alg::default_executor(), first, last, d_first, init, f);
+}
+
+// An output-only destination, such as std::back_inserter, cannot be split, so it is written serially in
+// order with a single state.
+template <class It, class Init, class Func>
+void generate_with_state(alg::executor & ex, const It & first, const It & last, const Init & init, const Func & f)
+{
+    alg::_CallScope scope("generate_with_state");
+    if constexpr (alg::_isOutputOnly<It>::value)
+    {
+        alg::_stateType<Init> state = init();
+        std::generate(first, last, [&]() { return f(state); });
+    }
+    else
+    {
+        alg::_withState(ex, init, [&f](auto & state, It from, const It & to)
+        {
+            for (; from != to; ++from)
+                *from = f(state);
+        }, std::distance(first, last), first);
+    }
+}
+
+template <class It, class Init, class Func>
+void generate_with_state(const It & first, const It & last, const Init & init, const Func & f)
+{
+    alg::generate_with_state(alg::default_executor(), first, last, init, f);
+}
+
+template <class It, class Init, class Func>
+void generate_n_with_state(alg::executor & ex, const It & first, size_t n, const Init & init, const Func & f)
+{
+    alg::_CallScope scope("generate_n_with_state");
+    if constexpr (alg::_isOutputOnly<It>::value)
+    {
+        alg::_stateType<Init> state = init();
+        std::generate_n(first, n, [&]() { return f(state); });
+    }
+    else
+    {
+        alg::_withState(ex, init, [&f](auto & state, It from, const It & to)
+        {
+            for (; from != to; ++from)
+                *from = f(state);
+        }, n, first);
+    }
+}
+
+template <class It, class Init, class Func>
+void generate_n_with_state(const It & first, size_t n, const Init & init, const Func & f)
+{
+    alg::generate_n_with_state(alg::default_executor(), first, n, init, f);
+}
+
+template <class It, class Func>
+void _generateRandom(It first, const It & last, size_t index, uint64_t seed, const Func & f)
+{
+    while (first != last)
+    {
+        std::array<alg::philox4x32, 4> lanes = alg::philox4x32::lanes(seed, index / 4);
+        for (size_t lane = index % 4; (lane < 4) && (first != last); ++lane, ++first, ++index)
+            *first = f(lanes[lane]);
+    }
+}
+
+// Element i gets f(rng) with rng the alg::philox4x32 of lane i % 4 of stream i / 4 of seed, so the output
+// depends only on the seed and f, not on the number of threads or on how the range is split. Every element
+// has its own sequence, and the first numbers of four elements cost one block.
+template <class It, class Func>
+alg::_ifRAIt<It, void> generate_random(alg::executor & ex, const It & first, const It & last, uint64_t seed, const Func & f)
+{
+    alg::_CallScope scope("generate_random");
+    alg::_stealingFor(ex, last - first, [&](size_t, size_t begin, size_t end)
+    {
+        alg::_generateRandom(first + begin, first + end, begin, seed, f);
+    });
+}
+
+template <class It, class Func>
+alg::_ifnotRAIt<It, void> generate_random(alg::executor & ex, const It & first, const It & last, uint64_t seed, const Func & f)
+{
+    alg::_CallScope scope("generate_random");
+    size_t n = std::distance(first, last);
+    size_t parts = alg::_partsFor(ex, n);
+    alg::_Scratch<std::tuple<It>> splited = alg::_splitN(n, parts, first);
+    ex.run_owned(parts, [&](size_t i)
+    {
+        alg::_generateRandom(std::get<0>(splited[i]), std::get<0>(splited[i + 1]), alg::_chunkBegin(n, parts, i), seed, f);
+        alg::_countElements(alg::_chunkBegin(n, parts, i + 1) - alg::_chunkBegin(n, parts, i));
+    });
+}
+
+template <class It, class Func>
+void generate_random(const It & first, const It & last, uint64_t seed, const Func & f)
+{
+    alg::generate_random(alg::default_executor(), first, last, seed, f);
+}
+
+template <class It, class Func>
+void generate_n_random(alg::executor & ex, const It & first, size_t n, uint64_t seed, const Func & f)
+{
+    alg::generate_random(ex, first, std::next(first, n), seed, f);
+}
+
+template <class It, class Func>
+void generate_n_random(const It & first, size_t n, uint64_t seed, const Func & f)
+{
+    alg::generate_n_random(alg::default_executor(), first, n, seed, f);
+}
+
+template <class InputIt, class OutputIt>
+void reverce_copy(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt first2)
+{
+    alg::_CallScope scope("reverce_copy");
+    alg::transform(ex, std::make_reverse_iterator(last1), std::make_reverse_iterator(first1), first2, [](const auto & item) { return item;});
+}
+
+template <class InputIt, class OutputIt>
+void reverce_copy(InputIt first1, const InputIt & last1, OutputIt first2)
+{
+    alg::reverce_copy(alg::default_executor(), first1, last1, first2);
+}
+
+template <class InputIt, class OutputIt, class Func, typename T>
+void replace_copy_if(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt first2, const Func & f, const T & new_value)
+{
+    alg::_CallScope scope("replace_copy_if");
+    alg::transform(ex, first1, last1, first2, [&f, &new_value](const auto & item) { return f(item) ? new_value : item; });
+}
+
+template <class InputIt, class OutputIt, class Func, typename T>
+void replace_copy_if(InputIt first1, const InputIt & last1, OutputIt first2, const Func & f, const T & new_value)
+{
+    alg::replace_copy_if(alg::default_executor(), first1, last1, first2, f, new_value);
+}
+
+template <class InputIt, class OutputIt, typename T>
+void replace_copy(alg::executor & ex, InputIt first1, const InputIt & last1, OutputIt first2, const T & old_value, const T & new_value)
+{
+    alg::_CallScope scope("replace_copy");
+    alg::transform(ex, first1, last1, first2, [&old_value, &new_value](const auto & item) { return (item == old_value) ? new_value : item; });
+}
+
+template <class InputIt, class OutputIt, typename T>
+void replace_copy(InputIt first1, const InputIt & last1, OutputIt first2, const T & old_value, const T & new_value)
+{
+    alg::replace_copy(alg::default_executor(), first1, last1, first2, old_value, new_value);
+}
+
+template <class It, class Func, typename T>
+void replace_if(alg::executor & ex, It first1, const It & last1, const Func & f, const T & new_value)
+{
+    alg::_CallScope scope("replace_if");
+    alg::for_each(ex, first1, last1, [&f, &new_value](auto & item) { if (f(item)) item = new_value; });
+}
+
+template <class It, class Func, typename T>
+void replace_if(It first1, const It & last1, const Func & f, const T & new_value)
+{
+    alg::replace_if(alg::default_executor(), first1, last1, f, new_value);
+}
+
+template <class It, typename T>
+void replace(alg::executor & ex, It first1, const It & last1, const T & old_value, const T & new_value)
+{
+    alg::_CallScope scope("replace");
+    using V = typename std::iterator_traits<It>::value_type;
+    if constexpr (alg::_isSimdRange<It>::value && std::is_convertible<T, V>::value)
+    {
+        V from;
+        if ((first1 != last1) && alg::_simdValue(old_value, from))
+        {
+            V * data = alg::_toPointer(first1);
+            V to = static_cast<V>(new_value);
+            alg::_stealingFor(ex, last1 - first1, [&](size_t, size_t begin, size_t end)
+            {
+                alg::_simdReplace(data + begin, end - begin, from, to);
+            });
+            return;
+        }
+    }
+    alg::for_each(ex, first1, last1, [&old_value, &new_value](auto & item) { if (item == old_value) item = new_value; });
+}
+
+template <class It, typename T>
+void replace(It first1, const It & last1, const T & old_value, const T & new_value)
+{
+    alg::replace(alg::default_executor(), first1, last1, old_value, new_value);
+}
+
+template <class It1, class It2, class Func>
+void _zipForEach(It1 first1, const It1 & last1, It2 first2, const Func & f)
+{
+    for (;first1 != last1; ++first1, ++first2)
+        f(*first1, *first2);
+}
+
+template <class It1, class It2, class Func>
+alg::_ifAllRAIt<void, It1, It2> zip_for_each(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, const Func & f)
+{
+    alg::_CallScope scope("zip_for_each");
+    alg::_stealingFor(ex, last1 - first1, [&](size_t, size_t begin, size_t end)
+    {
+        alg::_zipForEach(first1 + begin, first1 + end, first2 + begin, f);
+    });
+}
+
+template <class It1, class It2, class Func>
+alg::_ifAnyNotRAIt<void, It1, It2> zip_for_each(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, const Func & f)
+{
+    alg::_CallScope scope("zip_for_each");
+    // Two ranges cannot share one stream, so a single-pass one is walked serially.
+    if constexpr (alg::_isInputOnly<It1>::value || alg::_isInputOnly<It2>::value || alg::_isOutputOnly<It2>::value)
+        alg::_zipForEach(first1, last1, first2, f);
+    else
+    {
+        alg::_Scratch<std::tuple<It1, It2>> splited = alg::_splitTogether(ex.concurrency(), first1, last1, first2);
+        ex.run(ex.concurrency(), [&](size_t i)
+        {
+            alg::_zipForEach(std::get<0>(splited[i]), std::get<0>(splited[i + 1]), std::get<1>(splited[i]), f);
+        });
+    }
+}
+
+template <class It1, class It2, class Func>
+void zip_for_each(It1 first1, const It1 & last1, It2 first2, const Func & f)
+{
+    alg::zip_for_each(alg::default_executor(), first1, last1, first2, f);
+}
+
+
+// Counts the kept elements of every _split chunk, turns the counts into output offsets and lets every
+// chunk write its kept elements from its own offset, so the output order does not depend on the chunking.
+template <bool moving, class InputIt, class OutputIt, class Keep>
+OutputIt _compact(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, const Keep & keep)
+{
+    size_t parts = alg::_partsFor(ex, first, last);
+    alg::_Scratch<InputIt> splited = alg::_split(first, last, parts);
+    alg::_Scratch<size_t> offsets(parts + 1);
+    offsets[0] = 0;
+    ex.run_owned(parts, [&](size_t i)
+    {
+        size_t count = 0;
+        for (InputIt it = splited[i]; it != splited[i + 1]; ++it)
+            if (keep(it))
+                ++count;
+        offsets[i + 1] = count;
+        alg::_countRange(splited[i], splited[i + 1]);
+    });
+    std::partial_sum(offsets.get(), offsets.get() + parts + 1, offsets.get());
+    ex.run_owned(parts, [&](size_t i)
+    {
+        OutputIt out = d_first + offsets[i];
+        for (InputIt it = splited[i]; it != splited[i + 1]; ++it)
+            if (keep(it))
+            {
+                if constexpr (moving)
+                    *out = std::move(*it);
+                else
+                    *out = *it;
+                ++out;
+            }
+    });
+    OutputIt res = d_first + offsets[parts];
+    return res;
+}
+
+// Uninitialized storage for a temporary copy of a range, so the value type needs no default constructor.
+// moveFrom fills it all at once and leaves it empty if a move throws; afterwards every element is alive,
+// so the algorithms only assign to it and an exception never leaves constructed elements behind.
+template <class T>
+class _Buffer
+{
+private:
+    T * items;
+    size_t n;
+    size_t built;
+public:
+    explicit _Buffer(size_t n) : items(std::allocator<T>().allocate(n)), n(n), built(0) {}
+    ~_Buffer();
+    _Buffer(const _Buffer &) = delete;
+    _Buffer & operator=(const _Buffer &) = delete;
+
+    T * get() const { return items; }
+    T & operator[](size_t i) const { return items[i]; }
+    template <class It>
+    void moveFrom(alg::executor & ex, It src);
+};
+
+template <class T>
+alg::_Buffer<T>::~_Buffer()
+{
+    std::destroy(items, items + built);
+    std::allocator<T>().deallocate(items, n);
+}
+
+template <class T>
+template <class It>
+void alg::_Buffer<T>::moveFrom(alg::executor & ex, It src)
+{
+    size_t parts = alg::_partsFor(ex, n);
+    alg::_Scratch<std::tuple<It, T *>> splited = alg::_splitN(n, parts, src, items);
+    // uninitialized_move destroys what it built in a chunk it leaves by an exception; the chunks that
+    // finished are destroyed here.
+    alg::_Scratch<bool> moved(parts);
+    std::fill(moved.get(), moved.get() + parts, false);
+    try
+    {
+        ex.run_owned(parts, [&](size_t i)
+        {
+            std::uninitialized_move(std::get<0>(splited[i]), std::get<0>(splited[i + 1]), std::get<1>(splited[i]));
+            moved[i] = true;
+        });
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < parts; ++i)
+            if (moved[i])
+                std::destroy(std::get<1>(splited[i]), std::get<1>(splited[i + 1]));
+        throw;
+    }
+    built = n;
+}
+
+// Moves n elements from an RA source into any forward range, chunk by chunk.
+template <class SrcIt, class It>
+void _moveInto(alg::executor & ex, SrcIt src, size_t n, It d_first)
+{
+    size_t parts = alg::_partsFor(ex, n);
+    alg::_Scratch<std::tuple<SrcIt, It>> splited = alg::_splitN(n, parts, src, d_first);
+    ex.run_owned(parts, [&](size_t i)
+    {
+        std::move(std::get<0>(splited[i]), std::get<0>(splited[i + 1]), std::get<1>(splited[i]));
+    });
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifRAIt<OutputIt, OutputIt> copy_if(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("copy_if");
+    // _compact reads the input twice.
+    if constexpr (alg::_isInputOnly<InputIt>::value)
+        return std::copy_if(first, last, d_first, f);
+    else
+        return alg::_compact<false>(ex, first, last, d_first, [&f](const InputIt & it) { return static_cast<bool>(f(*it)); });
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifnotRAIt<OutputIt, OutputIt> copy_if(alg::executor &, InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("copy_if");
+    return std::copy_if(first, last, d_first, f);
+}
+
+template <class InputIt, class OutputIt, class Func>
+OutputIt copy_if(InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    return alg::copy_if(alg::default_executor(), first, last, d_first, f);
+}
+
+template <class InputIt, class OutputIt, class Func>
+OutputIt remove_copy_if(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("remove_copy_if");
+    return alg::copy_if(ex, first, last, d_first, std::not_fn(f));
+}
+
+template <class InputIt, class OutputIt, class Func>
+OutputIt remove_copy_if(InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    return alg::remove_copy_if(alg::default_executor(), first, last, d_first, f);
+}
+
+// The range is moved into a temporary buffer and the kept elements are compacted back; their relative
+// order is preserved. Other than random access ranges are compacted inside the buffer and moved back.
+template <class It, class Func>
+It remove_if(alg::executor & ex, It first, const It & last, const Func & f)
+{
+    alg::_CallScope scope("remove_if");
+    using T = typename std::iterator_traits<It>::value_type;
+    size_t n = std::distance(first, last);
+    alg::_Buffer<T> buffer(n);
+    buffer.moveFrom(ex, first);
+    if constexpr (std::is_same<typename std::iterator_traits<It>::iterator_category, std::random_access_iterator_tag>::value)
+        return alg::_compact<true>(ex, buffer.get(), buffer.get() + n, first, [&f](T * it) { return !f(*it); });
+    else
+    {
+        size_t kept = alg::remove_if(ex, buffer.get(), buffer.get() + n, f) - buffer.get();
+        alg::_moveInto(ex, buffer.get(), kept, first);
+        return std::next(first, kept);
+    }
+}
+
+template <class It, class Func>
+It remove_if(It first, const It & last, const Func & f)
+{
+    return alg::remove_if(alg::default_executor(), first, last, f);
+}
+
+template <bool moving, class InputIt, class OutputIt1, class OutputIt2, class Func>
+std::pair<OutputIt1, OutputIt2> _partitionCopy(alg::executor & ex, InputIt first, const InputIt & last,
+                                               OutputIt1 d_first_true, OutputIt2 d_first_false, const Func & f)
+{
+    size_t parts = alg::_partsFor(ex, first, last);
+    alg::_Scratch<InputIt> splited = alg::_split(first, last, parts);
+    alg::_Scratch<size_t> offsetsTrue(parts + 1);
+    alg::_Scratch<size_t> offsetsFalse(parts + 1);
+    offsetsTrue[0] = offsetsFalse[0] = 0;
+    ex.run(parts, [&](size_t i)
+    {
+        size_t countTrue = 0;
+        size_t countFalse = 0;
+        for (InputIt it = splited[i]; it != splited[i + 1]; ++it)
+            if (f(*it))
+                ++countTrue;
+            else
+                ++countFalse;
+        offsetsTrue[i + 1] = countTrue;
+        offsetsFalse[i + 1] = countFalse;
+        alg::_countElements(countTrue + countFalse);
+    });
+    std::partial_sum(offsetsTrue.get(), offsetsTrue.get() + parts + 1, offsetsTrue.get());
+    std::partial_sum(offsetsFalse.get(), offsetsFalse.get() + parts + 1, offsetsFalse.get());
+    ex.run(parts, [&](size_t i)
+    {
+        OutputIt1 outTrue = d_first_true + offsetsTrue[i];
+        OutputIt2 outFalse = d_first_false + offsetsFalse[i];
+        for (InputIt it = splited[i]; it != splited[i + 1]; ++it)
+        {
+            if constexpr (moving)
+            {
+                if (f(*it))
+                    *outTrue++ = std::move(*it);
+                else
+                    *outFalse++ = std::move(*it);
+            }
+            else
+            {
+                if (f(*it))
+                    *outTrue++ = *it;
+                else
+                    *outFalse++ = *it;
+            }
+        }
+    });
+    std::pair<OutputIt1, OutputIt2> res(d_first_true + offsetsTrue[parts], d_first_false + offsetsFalse[parts]);
+    return res;
+}
+
+template <class InputIt, class OutputIt1, class OutputIt2, class Func>
+alg::_ifAllRAIt<std::pair<OutputIt1, OutputIt2>, OutputIt1, OutputIt2> partition_copy(alg::executor & ex, InputIt first, const InputIt & last,
+                                                                                      OutputIt1 d_first_true, OutputIt2 d_first_false, const Func & f)
+{
+    alg::_CallScope scope("partition_copy");
+    // _partitionCopy reads the input twice.
+    if constexpr (alg::_isInputOnly<InputIt>::value)
+        return std::partition_copy(first, last, d_first_true, d_first_false, f);
+    else
+        return alg::_partitionCopy<false>(ex, first, last, d_first_true, d_first_false, f);
+}
+
+template <class InputIt, class OutputIt1, class OutputIt2, class Func>
+alg::_ifAnyNotRAIt<std::pair<OutputIt1, OutputIt2>, OutputIt1, OutputIt2> partition_copy(alg::executor &, InputIt first, const InputIt & last,
+                                                                                         OutputIt1 d_first_true, OutputIt2 d_first_false, const Func & f)
+{
+    alg::_CallScope scope("partition_copy");
+    return std::partition_copy(first, last, d_first_true, d_first_false, f);
+}
+
+template <class InputIt, class OutputIt1, class OutputIt2, class Func>
+std::pair<OutputIt1, OutputIt2> partition_copy(InputIt first, const InputIt & last, OutputIt1 d_first_true, OutputIt2 d_first_false, const Func & f)
+{
+    return alg::partition_copy(alg::default_executor(), first, last, d_first_true, d_first_false, f);
+}
+
+// Stable: both groups keep their relative order, which std::partition leaves unspecified. The range is
+// moved into a temporary buffer and partitioned back, the false group starting after the counted true
+// one. Other than random access ranges are partitioned inside the buffer and moved back.
+template <class It, class Func>
+It partition(alg::executor & ex, It first, const It & last, const Func & f)
+{
+    alg::_CallScope scope("partition");
+    using T = typename std::iterator_traits<It>::value_type;
+    size_t n = std::distance(first, last);
+    alg::_Buffer<T> buffer(n);
+    buffer.moveFrom(ex, first);
+    if constexpr (std::is_same<typename std::iterator_traits<It>::iterator_category, std::random_access_iterator_tag>::value)
+    {
+        size_t trues = alg::count_if(ex, buffer.get(), buffer.get() + n, f);
+        alg::_partitionCopy<true>(ex, buffer.get(), buffer.get() + n, first, first + trues, f);
+        return first + trues;
+    }
+    else
+    {
+        size_t trues = alg::partition(ex, buffer.get(), buffer.get() + n, f) - buffer.get();
+        alg::_moveInto(ex, buffer.get(), n, first);
+        return std::next(first, trues);
+    }
+}
+
+template <class It, class Func>
+It partition(It first, const It & last, const Func & f)
+{
+    return alg::partition(alg::default_executor(), first, last, f);
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifAllRAIt<OutputIt, InputIt, OutputIt> unique_copy(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("unique_copy");
+    return alg::_compact<false>(ex, first, last, d_first, [&first, &f](const InputIt & it) { return (it == first) || !f(*(it - 1), *it); });
+}
+
+template <class InputIt, class OutputIt, class Func>
+alg::_ifAnyNotRAIt<OutputIt, InputIt, OutputIt> unique_copy(alg::executor &, InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("unique_copy");
+    return std::unique_copy(first, last, d_first, f);
+}
+
+template <class InputIt, class OutputIt, class Func>
+OutputIt unique_copy(InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    return alg::unique_copy(alg::default_executor(), first, last, d_first, f);
+}
+
+template <class InputIt, class OutputIt>
+OutputIt unique_copy(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first)
+{
+    alg::_CallScope scope("unique_copy");
+    return alg::unique_copy(ex, first, last, d_first, std::equal_to<>());
+}
+
+template <class InputIt, class OutputIt>
+OutputIt unique_copy(InputIt first, const InputIt & last, OutputIt d_first)
+{
+    return alg::unique_copy(alg::default_executor(), first, last, d_first);
+}
+
+template <class It1, class It2, class Compare>
+size_t _coRank(size_t k, It1 first1, size_t n1, It2 first2, size_t n2, const Compare & comp)
+{
+    size_t low = k > n2 ? k - n2 : 0;
+    size_t high = std::min(k, n1);
+    while (low < high)
+    {
+        size_t i = low + (high - low) / 2;
+        if (!comp(first2[k - i - 1], first1[i]))
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+
+// Merge-path partitioning: every part produces an equal slice of the output, its inputs are found by
+// binary search on the diagonal. Ties are taken from the first range, as in std::merge.
+template <class It1, class It2, class OutputIt, class Compare>
+void _parallelMerge(alg::executor & ex, It1 first1, size_t n1, It2 first2, size_t n2, OutputIt d_first, const Compare & comp)
+{
+    size_t parts = alg::_partsFor(ex, n1 + n2);
+    alg::_Scratch<size_t> bounds = alg::_splitBounds(n1 + n2, parts);
+    ex.run(parts, [&](size_t i)
+    {
+        size_t i1 = alg::_coRank(bounds[i], first1, n1, first2, n2, comp);
+        size_t j1 = alg::_coRank(bounds[i + 1], first1, n1, first2, n2, comp);
+        std::merge(first1 + i1, first1 + j1, first2 + (bounds[i] - i1), first2 + (bounds[i + 1] - j1), d_first + bounds[i], comp);
+        alg::_countElements(bounds[i + 1] - bounds[i]);
+    });
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+alg::_ifAllRAIt<OutputIt, InputIt1, InputIt2, OutputIt> merge(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2,
+                                                              OutputIt d_first, const Compare & comp)
+{
+    alg::_CallScope scope("merge");
+    alg::_parallelMerge(ex, first1, last1 - first1, first2, last2 - first2, d_first, comp);
+    return d_first + ((last1 - first1) + (last2 - first2));
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+OutputIt merge(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first, const Compare & comp)
+{
+    return alg::merge(alg::default_executor(), first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt merge(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    alg::_CallScope scope("merge");
+    return alg::merge(ex, first1, last1, first2, last2, d_first, std::less<>());
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt merge(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    return alg::merge(alg::default_executor(), first1, last1, first2, last2, d_first);
+}
+
+template <class It, class Compare>
+alg::_ifRAIt<It, void> inplace_merge(alg::executor & ex, It first, It middle, It last, const Compare & comp)
+{
+    alg::_CallScope scope("inplace_merge");
+    using T = typename std::iterator_traits<It>::value_type;
+    alg::_Buffer<T> buffer(last - first);
+    buffer.moveFrom(ex, first);
+    alg::_parallelMerge(ex, std::make_move_iterator(buffer.get()), middle - first,
+                        std::make_move_iterator(buffer.get() + (middle - first)), last - middle, first, comp);
+}
+
+template <class It, class Compare>
+void inplace_merge(It first, It middle, It last, const Compare & comp)
+{
+    alg::inplace_merge(alg::default_executor(), first, middle, last, comp);
+}
+
+template <class It>
+void inplace_merge(alg::executor & ex, It first, It middle, It last)
+{
+    alg::_CallScope scope("inplace_merge");
+    alg::inplace_merge(ex, first, middle, last, std::less<>());
+}
+
+template <class It>
+void inplace_merge(It first, It middle, It last)
+{
+    alg::inplace_merge(alg::default_executor(), first, middle, last);
+}
+
+// Output iterator that only counts what is written through it.
+struct _CountingOutput
+{
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    size_t count = 0;
+
+    _CountingOutput & operator*() { return *this; }
+    template <class T>
+    _CountingOutput & operator=(const T &) { return *this; }
+    _CountingOutput & operator++() { ++count; return *this; }
+    _CountingOutput operator++(int) { _CountingOutput res = *this; ++count; return res; }
+};
+
+// Cuts of two sorted ranges into parts for the set operations. Every cut starts on the merge-path
+// diagonal and moves back to the first element equivalent to the next one of the merge, in both ranges,
+// so no run of equivalent elements is shared between parts and the serial algorithm on every pair of
+// slices gives exactly its share of the serial output. A run longer than a part stays in one part.
+template <class It1, class It2, class Compare>
+alg::_Scratch<std::pair<size_t, size_t>> _setCuts(size_t parts, It1 first1, size_t n1, It2 first2, size_t n2, const Compare & comp)
+{
+    alg::_Scratch<size_t> bounds = alg::_splitBounds(n1 + n2, parts);
+    alg::_Scratch<std::pair<size_t, size_t>> cuts(parts + 1);
+    for (size_t p = 0; p <= parts; ++p)
+    {
+        size_t i = alg::_coRank(bounds[p], first1, n1, first2, n2, comp);
+        size_t j = bounds[p] - i;
+        if (i < n1 && (j == n2 || !comp(first2[j], first1[i])))
+            cuts[p] = {std::lower_bound(first1, first1 + i, first1[i], comp) - first1, std::lower_bound(first2, first2 + j, first1[i], comp) - first2};
+        else if (j < n2)
+            cuts[p] = {std::lower_bound(first1, first1 + i, first2[j], comp) - first1, std::lower_bound(first2, first2 + j, first2[j], comp) - first2};
+        else
+            cuts[p] = {n1, n2};
+    }
+    return cuts;
+}
+
+// op(first1, last1, first2, last2, out) is the serial algorithm. A random-access output is written in
+// place once a first pass has counted what every part writes; any other output, such as a back_inserter,
+// gets the parts through a buffer each, in order.
+template <class It1, class It2, class OutputIt, class Compare, class SetOp>
+OutputIt _setOperation(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, const It2 & last2, OutputIt d_first,
+                       const Compare & comp, const SetOp & op)
+{
+    size_t n1 = last1 - first1;
+    size_t n2 = last2 - first2;
+    size_t parts = alg::_partsFor(ex, n1 + n2);
+    if (parts == 1)
+        return op(first1, last1, first2, last2, d_first);
+    alg::_Scratch<std::pair<size_t, size_t>> cuts = alg::_setCuts(parts, first1, n1, first2, n2, comp);
+    auto slice = [&](size_t i, auto out)
+    {
+        return op(first1 + cuts[i].first, first1 + cuts[i + 1].first, first2 + cuts[i].second, first2 + cuts[i + 1].second, out);
+    };
+    if constexpr (std::is_same<typename std::iterator_traits<OutputIt>::iterator_category, std::random_access_iterator_tag>::value)
+    {
+        alg::_Scratch<size_t> offsets(parts + 1);
+        offsets[0] = 0;
+        ex.run_owned(parts, [&](size_t i)
+        {
+            offsets[i + 1] = slice(i, alg::_CountingOutput()).count;
+            alg::_countElements((cuts[i + 1].first - cuts[i].first) + (cuts[i + 1].second - cuts[i].second));
+        });
+        std::partial_sum(offsets.get(), offsets.get() + parts + 1, offsets.get());
+        ex.run_owned(parts, [&](size_t i)
+        {
+            slice(i, d_first + offsets[i]);
+        });
+        return d_first + offsets[parts];
+    }
+    else
+    {
+        using T = typename std::iterator_traits<It1>::value_type;
+        alg::_Scratch<std::vector<T>> buffers(parts);
+        ex.run_owned(parts, [&](size_t i)
+        {
+            slice(i, std::back_inserter(buffers[i]));
+            alg::_countElements((cuts[i + 1].first - cuts[i].first) + (cuts[i + 1].second - cuts[i].second));
+        });
+        for (size_t i = 0; i < parts; ++i)
+            d_first = std::move(buffers[i].begin(), buffers[i].end(), d_first);
+        return d_first;
+    }
+}
+
+// Set operations over sorted ranges, cut by _setCuts, with the output of the serial std algorithms.
+// Inputs that are not random access run serially.
+
+// Elements of both ranges; of a run of equivalent elements the output has the longer count, the first
+// ones from the first range.
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+alg::_ifAllRAIt<OutputIt, InputIt1, InputIt2> set_union(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2,
+                                                        OutputIt d_first, const Compare & comp)
+{
+    alg::_CallScope scope("set_union");
+    return alg::_setOperation(ex, first1, last1, first2, last2, d_first, comp, [&comp](auto begin1, auto end1, auto begin2, auto end2, auto out)
+    {
+        return std::set_union(begin1, end1, begin2, end2, out, comp);
+    });
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+alg::_ifAnyNotRAIt<OutputIt, InputIt1, InputIt2> set_union(alg::executor &, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2,
+                                                           OutputIt d_first, const Compare & comp)
+{
+    alg::_CallScope scope("set_union");
+    return std::set_union(first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+OutputIt set_union(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first, const Compare & comp)
+{
+    return alg::set_union(alg::default_executor(), first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt set_union(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    alg::_CallScope scope("set_union");
+    return alg::set_union(ex, first1, last1, first2, last2, d_first, std::less<>());
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt set_union(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    return alg::set_union(alg::default_executor(), first1, last1, first2, last2, d_first);
+}
+
+// Of a run of equivalent elements the output has the shorter count, taken from the first range.
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+alg::_ifAllRAIt<OutputIt, InputIt1, InputIt2> set_intersection(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2,
+                                                               OutputIt d_first, const Compare & comp)
+{
+    alg::_CallScope scope("set_intersection");
+    return alg::_setOperation(ex, first1, last1, first2, last2, d_first, comp, [&comp](auto begin1, auto end1, auto begin2, auto end2, auto out)
+    {
+        return std::set_intersection(begin1, end1, begin2, end2, out, comp);
+    });
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+alg::_ifAnyNotRAIt<OutputIt, InputIt1, InputIt2> set_intersection(alg::executor &, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2,
+                                                                  OutputIt d_first, const Compare & comp)
+{
+    alg::_CallScope scope("set_intersection");
+    return std::set_intersection(first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+OutputIt set_intersection(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first, const Compare & comp)
+{
+    return alg::set_intersection(alg::default_executor(), first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt set_intersection(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    alg::_CallScope scope("set_intersection");
+    return alg::set_intersection(ex, first1, last1, first2, last2, d_first, std::less<>());
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt set_intersection(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    return alg::set_intersection(alg::default_executor(), first1, last1, first2, last2, d_first);
+}
+
+// Of a run of equivalent elements the output has the count of the first range less the one of the
+// second, taken from the end of the run in the first range.
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+alg::_ifAllRAIt<OutputIt, InputIt1, InputIt2> set_difference(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2,
+                                                             OutputIt d_first, const Compare & comp)
+{
+    alg::_CallScope scope("set_difference");
+    return alg::_setOperation(ex, first1, last1, first2, last2, d_first, comp, [&comp](auto begin1, auto end1, auto begin2, auto end2, auto out)
+    {
+        return std::set_difference(begin1, end1, begin2, end2, out, comp);
+    });
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+alg::_ifAnyNotRAIt<OutputIt, InputIt1, InputIt2> set_difference(alg::executor &, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2,
+                                                                OutputIt d_first, const Compare & comp)
+{
+    alg::_CallScope scope("set_difference");
+    return std::set_difference(first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt, class Compare>
+OutputIt set_difference(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first, const Compare & comp)
+{
+    return alg::set_difference(alg::default_executor(), first1, last1, first2, last2, d_first, comp);
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt set_difference(alg::executor & ex, InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    alg::_CallScope scope("set_difference");
+    return alg::set_difference(ex, first1, last1, first2, last2, d_first, std::less<>());
+}
+
+template <class InputIt1, class InputIt2, class OutputIt>
+OutputIt set_difference(InputIt1 first1, const InputIt1 & last1, InputIt2 first2, const InputIt2 & last2, OutputIt d_first)
+{
+    return alg::set_difference(alg::default_executor(), first1, last1, first2, last2, d_first);
+}
+
+// Parts stop early once one of them has found an element of the second range missing from the first.
+template <class It1, class It2, class Compare>
+alg::_ifAllRAIt<bool, It1, It2> includes(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, const It2 & last2, const Compare & comp)
+{
+    alg::_CallScope scope("includes");
+    size_t n1 = last1 - first1;
+    size_t n2 = last2 - first2;
+    if (n2 > n1)
+        return false;
+    size_t parts = alg::_partsFor(ex, n1 + n2);
+    if (parts == 1)
+        return std::includes(first1, last1, first2, last2, comp);
+    alg::_Scratch<std::pair<size_t, size_t>> cuts = alg::_setCuts(parts, first1, n1, first2, n2, comp);
+    std::atomic<bool> res(true);
+    ex.run(parts, [&](size_t i)
+    {
+        if (!res.load(std::memory_order_relaxed))
+            return;
+        if (!std::includes(first1 + cuts[i].first, first1 + cuts[i + 1].first, first2 + cuts[i].second, first2 + cuts[i + 1].second, comp))
+            res.store(false, std::memory_order_relaxed);
+        alg::_countElements((cuts[i + 1].first - cuts[i].first) + (cuts[i + 1].second - cuts[i].second));
+    });
+    return res.load();
+}
+
+template <class It1, class It2, class Compare>
+alg::_ifAnyNotRAIt<bool, It1, It2> includes(alg::executor &, It1 first1, const It1 & last1, It2 first2, const It2 & last2, const Compare & comp)
+{
+    alg::_CallScope scope("includes");
+    return std::includes(first1, last1, first2, last2, comp);
+}
+
+template <class It1, class It2, class Compare>
+bool includes(It1 first1, const It1 & last1, It2 first2, const It2 & last2, const Compare & comp)
+{
+    return alg::includes(alg::default_executor(), first1, last1, first2, last2, comp);
+}
+
+template <class It1, class It2>
+bool includes(alg::executor & ex, It1 first1, const It1 & last1, It2 first2, const It2 & last2)
+{
+    alg::_CallScope scope("includes");
+    return alg::includes(ex, first1, last1, first2, last2, std::less<>());
+}
+
+template <class It1, class It2>
+bool includes(It1 first1, const It1 & last1, It2 first2, const It2 & last2)
+{
+    return alg::includes(alg::default_executor(), first1, last1, first2, last2);
+}
+
+// Below this many elements per part the sorts fall back to the serial std algorithms.
+constexpr size_t _sort_part_cutoff = 1 << 12;
+
+template <class It, class Compare>
+alg::_ifRAIt<It, void> stable_sort(alg::executor & ex, It first, It last, const Compare & comp)
+{
+    alg::_CallScope scope("stable_sort");
+    using T = typename std::iterator_traits<It>::value_type;
+    size_t n = last - first;
+    size_t parts = ex.concurrency();
+    if (parts == 1 || n < parts * alg::_sort_part_cutoff)
+    {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+    alg::_Scratch<size_t> bounds = alg::_splitBounds(n, parts);
+    ex.run(parts, [&](size_t i)
+    {
+        std::stable_sort(first + bounds[i], first + bounds[i + 1], comp);
+    });
+    // The sorted parts are moved into the buffer first, so the merges only assign.
+    alg::_Buffer<T> buffer(n);
+    buffer.moveFrom(ex, first);
+    bool inBuffer = true;
+    for (size_t width = 1; width < parts; width *= 2)
+    {
+        for (size_t i = 0; i < parts; i += 2 * width)
+        {
+            size_t begin = bounds[i];
+            size_t middle = bounds[std::min(i + width, parts)];
+            size_t end = bounds[std::min(i + 2 * width, parts)];
+            if (inBuffer)
+                alg::_parallelMerge(ex, std::make_move_iterator(buffer.get() + begin), middle - begin,
+                                    std::make_move_iterator(buffer.get() + middle), end - middle, first + begin, comp);
+            else
+                alg::_parallelMerge(ex, std::make_move_iterator(first + begin), middle - begin,
+                                    std::make_move_iterator(first + middle), end - middle, buffer.get() + begin, comp);
+        }
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer)
+        alg::move(ex, buffer.get(), buffer.get() + n, first);
+}
+
+template <class It, class Compare>
+void stable_sort(It first, It last, const Compare & comp)
+{
+    alg::stable_sort(alg::default_executor(), first, last, comp);
+}
+
+template <class It>
+void stable_sort(alg::executor & ex, It first, It last)
+{
+    alg::_CallScope scope("stable_sort");
+    alg::stable_sort(ex, first, last, std::less<>());
+}
+
+template <class It>
+void stable_sort(It first, It last)
+{
+    alg::stable_sort(alg::default_executor(), first, last);
+}
+
+template <class T>
+using _radixKey = typename std::conditional<sizeof(T) == 1, uint8_t,
+                  typename std::conditional<sizeof(T) == 2, uint16_t,
+                  typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type>::type>::type;
+
+// Maps a value to an unsigned key with the same order.
+template <class T>
+alg::_radixKey<T> _toRadixKey(const T & item)
+{
+    using Key = alg::_radixKey<T>;
+    constexpr Key signBit = Key(1) << (sizeof(T) * 8 - 1);
+    Key key;
+    std::memcpy(&key, &item, sizeof(T));
+    if (std::is_floating_point<T>::value)
+        return (key & signBit) ? Key(~key) : Key(key | signBit);
+    if (std::is_signed<T>::value)
+        return key ^ signBit;
+    return key;
+}
+
+template <class It, class Compare>
+struct _isRadixSortable
+{
+    using T = typename std::iterator_traits<It>::value_type;
+    constexpr static bool value = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                  (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8) &&
+                                  (std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::less<>>::value);
+};
+
+template <class SrcIt, class DstIt>
+bool _radixPass(alg::executor & ex, SrcIt src, DstIt dst, size_t n, const size_t * bounds, size_t * counts, size_t shift)
+{
+    constexpr size_t radix = 256;
+    size_t parts = ex.concurrency();
+    ex.run(parts, [&](size_t i)
+    {
+        size_t * count = counts + i * radix;
+        std::fill(count, count + radix, 0);
+        for (size_t k = bounds[i]; k < bounds[i + 1]; ++k)
+            ++count[(alg::_toRadixKey(src[k]) >> shift) & (radix - 1)];
+    });
+    size_t offset = 0;
+    for (size_t digit = 0; digit < radix; ++digit)
+    {
+        size_t begin = offset;
+        for (size_t i = 0; i < parts; ++i)
+        {
+            size_t count = counts[i * radix + digit];
+            counts[i * radix + digit] = offset;
+            offset += count;
+        }
+        if (offset - begin == n)
+            return false;
+    }
+    ex.run(parts, [&](size_t i)
+    {
+        size_t * offsets = counts + i * radix;
+        for (size_t k = bounds[i]; k < bounds[i + 1]; ++k)
+            dst[offsets[(alg::_toRadixKey(src[k]) >> shift) & (radix - 1)]++] = src[k];
+    });
+    return true;
+}
+
+// LSD radix sort on 8-bit digits. Every pass counts the digits of each part, turns the counts into
+// per-part offsets (digit-major, so the scatter is stable) and scatters into the other buffer.
+// Passes where every element has the same digit are skipped.
+template <class It>
+void _radixSort(alg::executor & ex, It first, It last)
+{
+    using T = typename std::iterator_traits<It>::value_type;
+    size_t n = last - first;
+    size_t parts = ex.concurrency();
+    std::unique_ptr<T[]> buffer(new T[n]);
+    alg::_Scratch<size_t> bounds = alg::_splitBounds(n, parts);
+    alg::_Scratch<size_t> counts(parts * 256);
+    bool inBuffer = false;
+    for (size_t shift = 0; shift < sizeof(T) * 8; shift += 8)
+    {
+        bool moved = inBuffer ? alg::_radixPass(ex, buffer.get(), first, n, bounds.get(), counts.get(), shift)
+                              : alg::_radixPass(ex, first, buffer.get(), n, bounds.get(), counts.get(), shift);
+        inBuffer = inBuffer != moved;
+    }
+    if (inBuffer)
+        alg::copy(ex, buffer.get(), buffer.get() + n, first);
+}
+
+// Samplesort: splitters are taken from a regular oversampled sample, every part counts how many of
+// its elements fall into each bucket, the elements are moved into a buffer and scattered back from it,
+// and the buckets are sorted independently. Splitters are distinct and the elements equivalent to one
+// get a bucket of their own that needs no sorting, so repeated keys do not pile up in one bucket.
+template <class It, class Compare>
+void _sampleSort(alg::executor & ex, It first, It last, const Compare & comp)
+{
+    using T = typename std::iterator_traits<It>::value_type;
+    constexpr size_t oversampling = 32;
+    size_t n = last - first;
+    size_t parts = ex.concurrency();
+    size_t buckets = parts * 4;
+    std::vector<T> sample;
+    sample.reserve(buckets * oversampling);
+    for (size_t i = 0; i < buckets * oversampling; ++i)
+        sample.push_back(first[i * (n / (buckets * oversampling))]);
+    std::sort(sample.begin(), sample.end(), comp);
+    std::vector<T> splitters;
+    splitters.reserve(buckets - 1);
+    for (size_t b = 1; b < buckets; ++b)
+        if (splitters.empty() || comp(splitters.back(), sample[b * oversampling]))
+            splitters.push_back(sample[b * oversampling]);
+    // Bucket 2 * j holds the elements between splitters j - 1 and j, bucket 2 * j + 1 those equivalent to j.
+    buckets = 2 * splitters.size() + 1;
+    auto bucketOf = [&](const T & item) -> size_t
+    {
+        size_t j = std::upper_bound(splitters.begin(), splitters.end(), item, comp) - splitters.begin();
+        return (j > 0) && !comp(splitters[j - 1], item) ? 2 * j - 1 : 2 * j;
+    };
+
+    alg::_Scratch<It> splited = alg::_split(first, last, parts);
+    alg::_Scratch<size_t> offsets(parts * buckets);
+    std::fill(offsets.get(), offsets.get() + parts * buckets, 0);
+    ex.run(parts, [&](size_t i)
+    {
+        for (It it = splited[i]; it != splited[i + 1]; ++it)
+            ++offsets[i * buckets + bucketOf(*it)];
+    });
+    alg::_Scratch<size_t> bucketBounds(buckets + 1);
+    size_t offset = 0;
+    for (size_t b = 0; b < buckets; ++b)
+    {
+        bucketBounds[b] = offset;
+        for (size_t i = 0; i < parts; ++i)
+        {
+            size_t count = offsets[i * buckets + b];
+            offsets[i * buckets + b] = offset;
+            offset += count;
+        }
+    }
+    bucketBounds[buckets] = n;
+    alg::_Buffer<T> buffer(n);
+    buffer.moveFrom(ex, first);
+    ex.run(parts, [&](size_t i)
+    {
+        size_t * offset = offsets.get() + i * buckets;
+        for (T * it = buffer.get() + (splited[i] - first); it != buffer.get() + (splited[i + 1] - first); ++it)
+            first[offset[bucketOf(*it)]++] = std::move(*it);
+    });
+    ex.run(splitters.size() + 1, [&](size_t b)
+    {
+        std::sort(first + bucketBounds[2 * b], first + bucketBounds[2 * b + 1], comp);
+    });
+}
+
+// Arithmetic keys ordered by std::less take the radix sort, everything else the samplesort.
+template <class It, class Compare>
+alg::_ifRAIt<It, void> sort(alg::executor & ex, It first, It last, const Compare & comp)
+{
+    alg::_CallScope scope("sort");
+    size_t n = last - first;
+    size_t parts = ex.concurrency();
+    if (parts == 1 || n < parts * alg::_sort_part_cutoff)
+        std::sort(first, last, comp);
+    else if constexpr (alg::_isRadixSortable<It, Compare>::value)
+        alg::_radixSort(ex, first, last);
+    else
+        alg::_sampleSort(ex, first, last, comp);
+}
+
+template <class It, class Compare>
+void sort(It first, It last, const Compare & comp)
+{
+    alg::sort(alg::default_executor(), first, last, comp);
+}
+
+template <class It>
+void sort(alg::executor & ex, It first, It last)
+{
+    alg::_CallScope scope("sort");
+    alg::sort(ex, first, last, std::less<>());
+}
+
+template <class It>
+void sort(It first, It last)
+{
+    alg::sort(alg::default_executor(), first, last);
+}
+
+// Moves the elements of [first, last) ordered before lo to the front and those ordered after hi to the back,
+// by moving them into a buffer and scattering them back, and returns where the elements from lo to hi start
+// and end.
+template <class It, class T, class Compare>
+std::pair<It, It> _partition3(alg::executor & ex, It first, It last, const T & lo, const T & hi, const Compare & comp)
+{
+    size_t n = last - first;
+    size_t parts = alg::_partsFor(ex, first, last);
+    auto groupOf = [&](const T & item) -> size_t
+    {
+        return comp(item, lo) ? 0 : (comp(hi, item) ? 2 : 1);
+    };
+    alg::_Scratch<size_t> bounds = alg::_splitBounds(n, parts);
+    alg::_Scratch<size_t> offsets(parts * 3);
+    std::fill(offsets.get(), offsets.get() + parts * 3, 0);
+    ex.run_owned(parts, [&](size_t i)
+    {
+        for (It it = first + bounds[i]; it != first + bounds[i + 1]; ++it)
+            ++offsets[i * 3 + groupOf(*it)];
+        alg::_countElements(bounds[i + 1] - bounds[i]);
+    });
+    size_t starts[4] = {0, 0, 0, n};
+    size_t offset = 0;
+    for (size_t g = 0; g < 3; ++g)
+    {
+        starts[g] = offset;
+        for (size_t i = 0; i < parts; ++i)
+        {
+            size_t count = offsets[i * 3 + g];
+            offsets[i * 3 + g] = offset;
+            offset += count;
+        }
+    }
+    alg::_Buffer<typename std::iterator_traits<It>::value_type> buffer(n);
+    buffer.moveFrom(ex, first);
+    ex.run_owned(parts, [&](size_t i)
+    {
+        size_t * offset = offsets.get() + i * 3;
+        for (size_t k = bounds[i]; k < bounds[i + 1]; ++k)
+            first[offset[groupOf(buffer[k])]++] = std::move(buffer[k]);
+    });
+    return std::make_pair(first + starts[1], first + starts[2]);
+}
+
+// Every round takes a regular sample, picks the two sample elements a few ranks below and above where nth
+// falls, and keeps only the group nth lands in; the last few parts are left to std::nth_element.
+template <class It, class Compare>
+alg::_ifRAIt<It, void> nth_element(alg::executor & ex, It first, It nth, It last, const Compare & comp)
+{
+    alg::_CallScope scope("nth_element");
+    using T = typename std::iterator_traits<It>::value_type;
+    constexpr size_t sampleSize = 1024;
+    constexpr size_t margin = 32;
+    size_t parts = ex.concurrency();
+    while ((nth != last) && (parts > 1) && (static_cast<size_t>(last - first) >= parts * alg::_sort_part_cutoff))
+    {
+        size_t n = last - first;
+        std::vector<T> sample;
+        sample.reserve(sampleSize);
+        for (size_t i = 0; i < sampleSize; ++i)
+            sample.push_back(first[i * (n / sampleSize)]);
+        std::sort(sample.begin(), sample.end(), comp);
+        size_t rank = std::min(static_cast<size_t>(nth - first) / (n / sampleSize), sampleSize - 1);
+        const T & lo = sample[rank > margin ? rank - margin : 0];
+        const T & hi = sample[std::min(rank + margin, sampleSize - 1)];
+        std::pair<It, It> middle = alg::_partition3(ex, first, last, lo, hi, comp);
+        if (nth < middle.first)
+        {
+            last = middle.first;
+        }
+        else if (nth >= middle.second)
+        {
+            first = middle.second;
+        }
+        else
+        {
+            // Everything from lo to hi is equivalent, so nth already holds the right element.
+            if (!comp(lo, hi))
+                return;
+            if ((middle.first == first) && (middle.second == last))
+                break;
+            first = middle.first;
+            last = middle.second;
+        }
+    }
+    std::nth_element(first, nth, last, comp);
+}
+
+template <class It, class Compare>
+void nth_element(It first, It nth, It last, const Compare & comp)
+{
+    alg::nth_element(alg::default_executor(), first, nth, last, comp);
+}
+
+template <class It>
+void nth_element(alg::executor & ex, It first, It nth, It last)
+{
+    alg::nth_element(ex, first, nth, last, std::less<>());
+}
+
+template <class It>
+void nth_element(It first, It nth, It last)
+{
+    alg::nth_element(alg::default_executor(), first, nth, last);
+}
+
+// Bounded heaps are used while k is at most this fraction of the elements per part; above it a heap of k
+// costs more than selecting in a copy.
+constexpr size_t _top_k_heap_ratio = 256;
+
+// Keeps the best k elements of [first, last) under comp in heap, a heap with the worst of them on top.
+template <class T, class It, class Compare>
+void _inThreadTopK(std::vector<T> & heap, It first, const It & last, size_t k, const Compare & comp)
+{
+    for (; (first != last) && (heap.size() < k); ++first)
+        heap.push_back(*first);
+    std::make_heap(heap.begin(), heap.end(), comp);
+    for (; first != last; ++first)
+        if (comp(*first, heap.front()))
+        {
+            std::pop_heap(heap.begin(), heap.end(), comp);
+            heap.back() = *first;
+            std::push_heap(heap.begin(), heap.end(), comp);
+        }
+}
+
+// The k elements that come first under comp, in order. While k is small next to the part size every part
+// keeps a bounded heap of its best k elements and only the heaps are selected from; otherwise the
+// selection runs on a copy of the range. A single-pass range can be neither measured nor split, so it
+// feeds one heap serially.
+template <class It, class Compare>
+std::vector<typename std::iterator_traits<It>::value_type> _topK(alg::executor & ex, const It & first, const It & last, size_t k, const Compare & comp)
+{
+    using T = typename std::iterator_traits<It>::value_type;
+    std::vector<T> res;
+    if constexpr (alg::_isInputOnly<It>::value)
+    {
+        if (k != 0)
+            alg::_inThreadTopK(res, first, last, k, comp);
+    }
+    else
+    {
+        size_t n = std::distance(first, last);
+        k = std::min(k, n);
+        if (k == 0)
+            return res;
+        size_t parts = alg::_partsFor(ex, first, last);
+        if (k * parts * alg::_top_k_heap_ratio <= n)
+        {
+            alg::_Scratch<It> splited = alg::_split(first, last, parts);
+            std::unique_ptr<std::vector<T>[]> heaps(new std::vector<T>[parts]);
+            ex.run_owned(parts, [&](size_t i)
+            {
+                heaps[i].reserve(k);
+                alg::_inThreadTopK(heaps[i], splited[i], splited[i + 1], k, comp);
+                alg::_countRange(splited[i], splited[i + 1]);
+            });
+            res.reserve(parts * k);
+            for (size_t i = 0; i < parts; ++i)
+                std::move(heaps[i].begin(), heaps[i].end(), std::back_inserter(res));
+        }
+        else
+        {
+            res.resize(n);
+            alg::copy(ex, first, last, res.begin());
+        }
+        if (k < res.size())
+        {
+            alg::nth_element(ex, res.begin(), res.begin() + k, res.end(), comp);
+            res.erase(res.begin() + k, res.end());
+        }
+    }
+    alg::sort(ex, res.begin(), res.end(), comp);
+    return res;
+}
+
+// Small k, in parallel: the heaps of _topK give the k-th element, every part lists where its elements
+// ordered before it are and where the first k of those equivalent to it are, and these are swapped to
+// the front in order.
+template <class It, class Compare>
+void _partialSortFew(alg::executor & ex, It first, It middle, It last, const Compare & comp)
+{
+    using T = typename std::iterator_traits<It>::value_type;
+    size_t n = last - first;
+    size_t k = middle - first;
+    const T kth = alg::_topK(ex, first, last, k, comp)[k - 1];
+    size_t parts = alg::_partsFor(ex, first, last);
+    alg::_Scratch<size_t> bounds = alg::_splitBounds(n, parts);
+    std::unique_ptr<std::vector<size_t>[]> before(new std::vector<size_t>[parts]);
+    std::unique_ptr<std::vector<size_t>[]> equivalent(new std::vector<size_t>[parts]);
+    ex.run_owned(parts, [&](size_t i)
+    {
+        for (size_t j = bounds[i]; j < bounds[i + 1]; ++j)
+        {
+            if (comp(first[j], kth))
+                before[i].push_back(j);
+            else if (!comp(kth, first[j]) && (equivalent[i].size() < k))
+                equivalent[i].push_back(j);
+        }
+        alg::_countElements(bounds[i + 1] - bounds[i]);
+    });
+    std::vector<size_t> positions;
+    positions.reserve(k);
+    for (size_t i = 0; i < parts; ++i)
+        positions.insert(positions.end(), before[i].begin(), before[i].end());
+    for (size_t i = 0; (i < parts) && (positions.size() < k); ++i)
+        positions.insert(positions.end(), equivalent[i].begin(), equivalent[i].begin() + std::min(k - positions.size(), equivalent[i].size()));
+    std::sort(positions.begin(), positions.end());
+    for (size_t i = 0; i < k; ++i)
+        std::iter_swap(first + i, first + positions[i]);
+    alg::sort(ex, first, middle, comp);
+}
+
+// Small k take a bounded heap, the rest nth_element and a sort of the front.
+template <class It, class Compare>
+alg::_ifRAIt<It, void> partial_sort(alg::executor & ex, It first, It middle, It last, const Compare & comp)
+{
+    alg::_CallScope scope("partial_sort");
+    size_t n = last - first;
+    size_t k = middle - first;
+    size_t parts = ex.concurrency();
+    if (k == 0)
+        return;
+    if (parts == 1 || n < parts * alg::_sort_part_cutoff)
+    {
+        if (k * alg::_top_k_heap_ratio <= n)
+        {
+            std::partial_sort(first, middle, last, comp);
+            return;
+        }
+    }
+    else if (k * parts * alg::_top_k_heap_ratio <= n)
+    {
+        alg::_partialSortFew(ex, first, middle, last, comp);
+        return;
+    }
+    alg::nth_element(ex, first, middle, last, comp);
+    alg::sort(ex, first, middle, comp);
+}
+
+template <class It, class Compare>
+void partial_sort(It first, It middle, It last, const Compare & comp)
+{
+    alg::partial_sort(alg::default_executor(), first, middle, last, comp);
+}
+
+template <class It>
+void partial_sort(alg::executor & ex, It first, It middle, It last)
+{
+    alg::partial_sort(ex, first, middle, last, std::less<>());
+}
+
+template <class It>
+void partial_sort(It first, It middle, It last)
+{
+    alg::partial_sort(alg::default_executor(), first, middle, last);
+}
+
+// Unlike the std algorithms the default order is std::greater: top_k(first, last, k) gives the k largest
+// elements, largest first.
+template <class It, class Compare>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(alg::executor & ex, const It & first, const It & last, size_t k, const Compare & comp)
+{
+    alg::_CallScope scope("top_k");
+    return alg::_topK(ex, first, last, k, comp);
+}
+
+template <class It, class Compare>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(const It & first, const It & last, size_t k, const Compare & comp)
+{
+    return alg::top_k(alg::default_executor(), first, last, k, comp);
+}
+
+template <class It>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(alg::executor & ex, const It & first, const It & last, size_t k)
+{
+    return alg::top_k(ex, first, last, k, std::greater<>());
+}
+
+template <class It>
+std::vector<typename std::iterator_traits<It>::value_type> top_k(const It & first, const It & last, size_t k)
+{
+    return alg::top_k(alg::default_executor(), first, last, k);
+}
+
+template <class InputIt, class OutputIt, class Compare>
+OutputIt partial_sort_copy(alg::executor & ex, const InputIt & first, const InputIt & last, OutputIt d_first, const OutputIt & d_last, const Compare & comp)
+{
+    alg::_CallScope scope("partial_sort_copy");
+    auto res = alg::_topK(ex, first, last, std::distance(d_first, d_last), comp);
+    return std::move(res.begin(), res.end(), d_first);
+}
+
+template <class InputIt, class OutputIt, class Compare>
+OutputIt partial_sort_copy(const InputIt & first, const InputIt & last, OutputIt d_first, const OutputIt & d_last, const Compare & comp)
+{
+    return alg::partial_sort_copy(alg::default_executor(), first, last, d_first, d_last, comp);
+}
+
+template <class InputIt, class OutputIt>
+OutputIt partial_sort_copy(alg::executor & ex, const InputIt & first, const InputIt & last, OutputIt d_first, const OutputIt & d_last)
+{
+    return alg::partial_sort_copy(ex, first, last, d_first, d_last, std::less<>());
+}
+
+template <class InputIt, class OutputIt>
+OutputIt partial_sort_copy(const InputIt & first, const InputIt & last, OutputIt d_first, const OutputIt & d_last)
+{
+    return alg::partial_sort_copy(alg::default_executor(), first, last, d_first, d_last);
 }
 
 }
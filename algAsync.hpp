@@ -0,0 +1,1165 @@
+#ifndef ALGASYNC_HPP
+#define ALGASYNC_HPP
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "alg.hpp"
+
+// alg::async::name(ex, args...) starts alg::name(ex, args...) on a worker of ex and returns a handle at once.
+// The arguments are copied into the call; the ranges they point to have to outlive it. Dropping a handle
+// does not wait for or stop the call, and an executor finishes every call posted to it before it goes away.
+namespace alg
+{
+
+struct _AsyncVoid
+{
+};
+
+// Shared by a handle, the call and the continuations chained to it. A call becomes eligible to run when it
+// is launched or when the call it continues is done; it runs once, on whichever thread claims it first.
+template <class T>
+struct _AsyncState
+{
+    using Stored = typename std::conditional<std::is_void<T>::value, alg::_AsyncVoid, T>::type;
+
+    alg::executor & ex;
+    std::function<T()> task;
+    std::atomic<bool> cancelRequested;
+    std::atomic<bool> claimed;
+    std::atomic<bool> eligible;
+    std::mutex mutex;
+    std::condition_variable doneCv;
+    bool done;
+    std::optional<Stored> value;
+    std::exception_ptr error;
+    std::vector<std::function<void()>> continuations;
+
+    explicit _AsyncState(alg::executor & ex) : ex(ex), cancelRequested(false), claimed(false), eligible(false), done(false) {}
+
+    void execute();
+    void wait();
+    bool whenDone(std::function<void()> f);
+};
+
+template <class T>
+void alg::_AsyncState<T>::execute()
+{
+    if (claimed.exchange(true))
+        return;
+    const std::atomic<bool> * outerCancel = alg::_current_cancel;
+    alg::_current_cancel = &cancelRequested;
+    try
+    {
+        alg::_throwIfCancelled();
+        if constexpr (std::is_void<T>::value)
+        {
+            task();
+            value.emplace();
+        }
+        else
+            value.emplace(task());
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    alg::_current_cancel = outerCancel;
+    task = nullptr;
+    std::vector<std::function<void()>> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        next.swap(continuations);
+    }
+    doneCv.notify_all();
+    for (std::function<void()> & f : next)
+        f();
+}
+
+// An eligible call nobody has started is run here instead of waited for, so waiting from a task cannot
+// stall on workers that are all waiting too.
+template <class T>
+void alg::_AsyncState<T>::wait()
+{
+    if (eligible.load())
+        execute();
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this] { return done; });
+}
+
+// Queues f to run on the thread that finishes the call; returns false when it is already finished.
+template <class T>
+bool alg::_AsyncState<T>::whenDone(std::function<void()> f)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (done)
+        return false;
+    continuations.push_back(std::move(f));
+    return true;
+}
+
+template <class T>
+void _startAsync(const std::shared_ptr<alg::_AsyncState<T>> & state)
+{
+    state->eligible = true;
+    state->ex.post([state] { state->execute(); });
+}
+
+template <class T>
+struct _AsyncResult
+{
+    using type = const T &;
+};
+
+template <>
+struct _AsyncResult<void>
+{
+    using type = void;
+};
+
+template <class T, class Func>
+struct _ThenResult
+{
+    using type = std::invoke_result_t<Func &, T &>;
+};
+
+template <class Func>
+struct _ThenResult<void, Func>
+{
+    using type = std::invoke_result_t<Func &>;
+};
+
+namespace async
+{
+
+template <class T>
+class handle
+{
+private:
+    std::shared_ptr<alg::_AsyncState<T>> state;
+public:
+    handle() = default;
+    explicit handle(std::shared_ptr<alg::_AsyncState<T>> state) : state(std::move(state)) {}
+
+    bool valid() const { return state != nullptr; }
+    bool ready() const;
+    void wait() const;
+    // Waits and returns the result, or rethrows what the call threw; alg::operation_cancelled if it was cancelled.
+    typename alg::_AsyncResult<T>::type get() const;
+    // The call stops at its next task with alg::operation_cancelled; a call that has not started never runs.
+    void cancel() const;
+    // Runs f(result) as a new call once this one is done, on the thread that finished it, and f() for handle<void>.
+    // If this call fails, the continuation fails with the same exception without running f.
+    template <class Func>
+    alg::async::handle<typename alg::_ThenResult<T, Func>::type> then(Func f) const;
+};
+
+template <class T>
+bool alg::async::handle<T>::ready() const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->done;
+}
+
+template <class T>
+void alg::async::handle<T>::wait() const
+{
+    state->wait();
+}
+
+template <class T>
+typename alg::_AsyncResult<T>::type alg::async::handle<T>::get() const
+{
+    state->wait();
+    if (state->error)
+        std::rethrow_exception(state->error);
+    if constexpr (!std::is_void<T>::value)
+        return *state->value;
+}
+
+template <class T>
+void alg::async::handle<T>::cancel() const
+{
+    state->cancelRequested = true;
+}
+
+template <class T>
+template <class Func>
+alg::async::handle<typename alg::_ThenResult<T, Func>::type> alg::async::handle<T>::then(Func f) const
+{
+    using R = typename alg::_ThenResult<T, Func>::type;
+    std::shared_ptr<alg::_AsyncState<T>> prev = state;
+    std::shared_ptr<alg::_AsyncState<R>> next = std::make_shared<alg::_AsyncState<R>>(prev->ex);
+    next->task = [prev, f]() mutable -> R
+    {
+        if (prev->error)
+            std::rethrow_exception(prev->error);
+        if constexpr (std::is_void<T>::value)
+            return f();
+        else
+            return f(*prev->value);
+    };
+    bool queued = prev->whenDone([next]
+    {
+        next->eligible = true;
+        next->execute();
+    });
+    // Already done: the continuation still must not run on the caller.
+    if (!queued)
+        alg::_startAsync(next);
+    return alg::async::handle<R>(next);
+}
+
+// Runs f() on a worker of ex.
+template <class Func>
+alg::async::handle<std::invoke_result_t<Func &>> launch(alg::executor & ex, Func f)
+{
+    using R = std::invoke_result_t<Func &>;
+    std::shared_ptr<alg::_AsyncState<R>> state = std::make_shared<alg::_AsyncState<R>>(ex);
+    state->task = std::move(f);
+    alg::_startAsync(state);
+    return alg::async::handle<R>(state);
+}
+
+template <class Func>
+alg::async::handle<std::invoke_result_t<Func &>> launch(Func f)
+{
+    return alg::async::launch(alg::default_executor(), std::move(f));
+}
+
+template <class... Args>
+auto find_any_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::find_any_if(ex, args...); });
+}
+
+template <class... Args>
+auto find_any_if(Args... args)
+{
+    return alg::async::find_any_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto find_first_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::find_first_if(ex, args...); });
+}
+
+template <class... Args>
+auto find_first_if(Args... args)
+{
+    return alg::async::find_first_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto find(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::find(ex, args...); });
+}
+
+template <class... Args>
+auto find(Args... args)
+{
+    return alg::async::find(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto find_any(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::find_any(ex, args...); });
+}
+
+template <class... Args>
+auto find_any(Args... args)
+{
+    return alg::async::find_any(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto find_any_if_not(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::find_any_if_not(ex, args...); });
+}
+
+template <class... Args>
+auto find_any_if_not(Args... args)
+{
+    return alg::async::find_any_if_not(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto adjacent_find(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::adjacent_find(ex, args...); });
+}
+
+template <class... Args>
+auto adjacent_find(Args... args)
+{
+    return alg::async::adjacent_find(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto adjacent_find_any(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::adjacent_find_any(ex, args...); });
+}
+
+template <class... Args>
+auto adjacent_find_any(Args... args)
+{
+    return alg::async::adjacent_find_any(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto search(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::search(ex, args...); });
+}
+
+template <class... Args>
+auto search(Args... args)
+{
+    return alg::async::search(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto search_any(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::search_any(ex, args...); });
+}
+
+template <class... Args>
+auto search_any(Args... args)
+{
+    return alg::async::search_any(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto search_n(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::search_n(ex, args...); });
+}
+
+template <class... Args>
+auto search_n(Args... args)
+{
+    return alg::async::search_n(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto search_n_any(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::search_n_any(ex, args...); });
+}
+
+template <class... Args>
+auto search_n_any(Args... args)
+{
+    return alg::async::search_n_any(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto all_of(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::all_of(ex, args...); });
+}
+
+template <class... Args>
+auto all_of(Args... args)
+{
+    return alg::async::all_of(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto any_of(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::any_of(ex, args...); });
+}
+
+template <class... Args>
+auto any_of(Args... args)
+{
+    return alg::async::any_of(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto none_of(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::none_of(ex, args...); });
+}
+
+template <class... Args>
+auto none_of(Args... args)
+{
+    return alg::async::none_of(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto for_each(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::for_each(ex, args...); });
+}
+
+template <class... Args>
+auto for_each(Args... args)
+{
+    return alg::async::for_each(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto transform_reduce(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::transform_reduce(ex, args...); });
+}
+
+template <class... Args>
+auto transform_reduce(Args... args)
+{
+    return alg::async::transform_reduce(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto reduce(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::reduce(ex, args...); });
+}
+
+template <class... Args>
+auto reduce(Args... args)
+{
+    return alg::async::reduce(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto accumulate(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::accumulate(ex, args...); });
+}
+
+template <class... Args>
+auto accumulate(Args... args)
+{
+    return alg::async::accumulate(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto count_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::count_if(ex, args...); });
+}
+
+template <class... Args>
+auto count_if(Args... args)
+{
+    return alg::async::count_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto count(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::count(ex, args...); });
+}
+
+template <class... Args>
+auto count(Args... args)
+{
+    return alg::async::count(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto histogram(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::histogram(ex, args...); });
+}
+
+template <class... Args>
+auto histogram(Args... args)
+{
+    return alg::async::histogram(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto reduce_by_key(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::reduce_by_key(ex, args...); });
+}
+
+template <class... Args>
+auto reduce_by_key(Args... args)
+{
+    return alg::async::reduce_by_key(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto count_by_key(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::count_by_key(ex, args...); });
+}
+
+template <class... Args>
+auto count_by_key(Args... args)
+{
+    return alg::async::count_by_key(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto transform_inclusive_scan(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::transform_inclusive_scan(ex, args...); });
+}
+
+template <class... Args>
+auto transform_inclusive_scan(Args... args)
+{
+    return alg::async::transform_inclusive_scan(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto transform_exclusive_scan(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::transform_exclusive_scan(ex, args...); });
+}
+
+template <class... Args>
+auto transform_exclusive_scan(Args... args)
+{
+    return alg::async::transform_exclusive_scan(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto inclusive_scan(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::inclusive_scan(ex, args...); });
+}
+
+template <class... Args>
+auto inclusive_scan(Args... args)
+{
+    return alg::async::inclusive_scan(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto exclusive_scan(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::exclusive_scan(ex, args...); });
+}
+
+template <class... Args>
+auto exclusive_scan(Args... args)
+{
+    return alg::async::exclusive_scan(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto mismatch_any(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::mismatch_any(ex, args...); });
+}
+
+template <class... Args>
+auto mismatch_any(Args... args)
+{
+    return alg::async::mismatch_any(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto mismatch(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::mismatch(ex, args...); });
+}
+
+template <class... Args>
+auto mismatch(Args... args)
+{
+    return alg::async::mismatch(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto equal(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::equal(ex, args...); });
+}
+
+template <class... Args>
+auto equal(Args... args)
+{
+    return alg::async::equal(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto transform(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::transform(ex, args...); });
+}
+
+template <class... Args>
+auto transform(Args... args)
+{
+    return alg::async::transform(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto transform_n(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::transform_n(ex, args...); });
+}
+
+template <class... Args>
+auto transform_n(Args... args)
+{
+    return alg::async::transform_n(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto copy(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::copy(ex, args...); });
+}
+
+template <class... Args>
+auto copy(Args... args)
+{
+    return alg::async::copy(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto copy_n(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::copy_n(ex, args...); });
+}
+
+template <class... Args>
+auto copy_n(Args... args)
+{
+    return alg::async::copy_n(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto copy_backward(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::copy_backward(ex, args...); });
+}
+
+template <class... Args>
+auto copy_backward(Args... args)
+{
+    return alg::async::copy_backward(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto move(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::move(ex, args...); });
+}
+
+template <class... Args>
+auto move(Args... args)
+{
+    return alg::async::move(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto move_backward(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::move_backward(ex, args...); });
+}
+
+template <class... Args>
+auto move_backward(Args... args)
+{
+    return alg::async::move_backward(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto fill(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::fill(ex, args...); });
+}
+
+template <class... Args>
+auto fill(Args... args)
+{
+    return alg::async::fill(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto fill_n(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::fill_n(ex, args...); });
+}
+
+template <class... Args>
+auto fill_n(Args... args)
+{
+    return alg::async::fill_n(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto first_touch_fill(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::first_touch_fill(ex, args...); });
+}
+
+template <class... Args>
+auto first_touch_fill(Args... args)
+{
+    return alg::async::first_touch_fill(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto generate(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::generate(ex, args...); });
+}
+
+template <class... Args>
+auto generate(Args... args)
+{
+    return alg::async::generate(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto generate_n(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::generate_n(ex, args...); });
+}
+
+template <class... Args>
+auto generate_n(Args... args)
+{
+    return alg::async::generate_n(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto for_each_with_state(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::for_each_with_state(ex, args...); });
+}
+
+template <class... Args>
+auto for_each_with_state(Args... args)
+{
+    return alg::async::for_each_with_state(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto transform_with_state(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::transform_with_state(ex, args...); });
+}
+
+template <class... Args>
+auto transform_with_state(Args... args)
+{
+    return alg::async::transform_with_state(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto generate_with_state(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::generate_with_state(ex, args...); });
+}
+
+template <class... Args>
+auto generate_with_state(Args... args)
+{
+    return alg::async::generate_with_state(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto generate_n_with_state(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::generate_n_with_state(ex, args...); });
+}
+
+template <class... Args>
+auto generate_n_with_state(Args... args)
+{
+    return alg::async::generate_n_with_state(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto generate_random(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::generate_random(ex, args...); });
+}
+
+template <class... Args>
+auto generate_random(Args... args)
+{
+    return alg::async::generate_random(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto generate_n_random(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::generate_n_random(ex, args...); });
+}
+
+template <class... Args>
+auto generate_n_random(Args... args)
+{
+    return alg::async::generate_n_random(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto reverce_copy(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::reverce_copy(ex, args...); });
+}
+
+template <class... Args>
+auto reverce_copy(Args... args)
+{
+    return alg::async::reverce_copy(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto replace_copy_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::replace_copy_if(ex, args...); });
+}
+
+template <class... Args>
+auto replace_copy_if(Args... args)
+{
+    return alg::async::replace_copy_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto replace_copy(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::replace_copy(ex, args...); });
+}
+
+template <class... Args>
+auto replace_copy(Args... args)
+{
+    return alg::async::replace_copy(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto replace_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::replace_if(ex, args...); });
+}
+
+template <class... Args>
+auto replace_if(Args... args)
+{
+    return alg::async::replace_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto replace(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::replace(ex, args...); });
+}
+
+template <class... Args>
+auto replace(Args... args)
+{
+    return alg::async::replace(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto zip_for_each(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::zip_for_each(ex, args...); });
+}
+
+template <class... Args>
+auto zip_for_each(Args... args)
+{
+    return alg::async::zip_for_each(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto copy_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::copy_if(ex, args...); });
+}
+
+template <class... Args>
+auto copy_if(Args... args)
+{
+    return alg::async::copy_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto remove_copy_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::remove_copy_if(ex, args...); });
+}
+
+template <class... Args>
+auto remove_copy_if(Args... args)
+{
+    return alg::async::remove_copy_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto remove_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::remove_if(ex, args...); });
+}
+
+template <class... Args>
+auto remove_if(Args... args)
+{
+    return alg::async::remove_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto partition_copy(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::partition_copy(ex, args...); });
+}
+
+template <class... Args>
+auto partition_copy(Args... args)
+{
+    return alg::async::partition_copy(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto partition(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::partition(ex, args...); });
+}
+
+template <class... Args>
+auto partition(Args... args)
+{
+    return alg::async::partition(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto unique_copy(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::unique_copy(ex, args...); });
+}
+
+template <class... Args>
+auto unique_copy(Args... args)
+{
+    return alg::async::unique_copy(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto merge(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::merge(ex, args...); });
+}
+
+template <class... Args>
+auto merge(Args... args)
+{
+    return alg::async::merge(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto inplace_merge(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::inplace_merge(ex, args...); });
+}
+
+template <class... Args>
+auto inplace_merge(Args... args)
+{
+    return alg::async::inplace_merge(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto set_union(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::set_union(ex, args...); });
+}
+
+template <class... Args>
+auto set_union(Args... args)
+{
+    return alg::async::set_union(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto set_intersection(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::set_intersection(ex, args...); });
+}
+
+template <class... Args>
+auto set_intersection(Args... args)
+{
+    return alg::async::set_intersection(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto set_difference(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::set_difference(ex, args...); });
+}
+
+template <class... Args>
+auto set_difference(Args... args)
+{
+    return alg::async::set_difference(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto includes(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::includes(ex, args...); });
+}
+
+template <class... Args>
+auto includes(Args... args)
+{
+    return alg::async::includes(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto stable_sort(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::stable_sort(ex, args...); });
+}
+
+template <class... Args>
+auto stable_sort(Args... args)
+{
+    return alg::async::stable_sort(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto sort(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::sort(ex, args...); });
+}
+
+template <class... Args>
+auto sort(Args... args)
+{
+    return alg::async::sort(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto nth_element(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::nth_element(ex, args...); });
+}
+
+template <class... Args>
+auto nth_element(Args... args)
+{
+    return alg::async::nth_element(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto partial_sort(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::partial_sort(ex, args...); });
+}
+
+template <class... Args>
+auto partial_sort(Args... args)
+{
+    return alg::async::partial_sort(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto partial_sort_copy(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::partial_sort_copy(ex, args...); });
+}
+
+template <class... Args>
+auto partial_sort_copy(Args... args)
+{
+    return alg::async::partial_sort_copy(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto top_k(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::top_k(ex, args...); });
+}
+
+template <class... Args>
+auto top_k(Args... args)
+{
+    return alg::async::top_k(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto for_each_index(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::for_each_index(ex, args...); });
+}
+
+template <class... Args>
+auto for_each_index(Args... args)
+{
+    return alg::async::for_each_index(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto transform_2d(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::transform_2d(ex, args...); });
+}
+
+template <class... Args>
+auto transform_2d(Args... args)
+{
+    return alg::async::transform_2d(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto stream_for_each(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::stream_for_each(ex, args...); });
+}
+
+template <class... Args>
+auto stream_for_each(Args... args)
+{
+    return alg::async::stream_for_each(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto stream_count_if(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::stream_count_if(ex, args...); });
+}
+
+template <class... Args>
+auto stream_count_if(Args... args)
+{
+    return alg::async::stream_count_if(alg::default_executor(), args...);
+}
+
+template <class... Args>
+auto stream_transform(alg::executor & ex, Args... args)
+{
+    return alg::async::launch(ex, [&ex, args...]() mutable { return alg::stream_transform(ex, args...); });
+}
+
+template <class... Args>
+auto stream_transform(Args... args)
+{
+    return alg::async::stream_transform(alg::default_executor(), args...);
+}
+
+}
+
+}
+
+#endif // ALGASYNC_HPP
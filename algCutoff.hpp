@@ -0,0 +1,101 @@
+#ifndef ALGCUTOFF_HPP
+#define ALGCUTOFF_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "algThreads.hpp"
+
+namespace alg
+{
+
+struct cutoff_thresholds
+{
+    // Work a part has to get, in nanoseconds, before waking a worker for it pays off.
+    size_t min_part_ns;
+    // Elements a part has to get when the cost of an element is not measured, for cheap element operations.
+    size_t min_part_elements;
+};
+
+inline std::atomic<size_t> _min_part_ns(0);
+inline std::atomic<size_t> _min_part_elements(0);
+inline std::once_flag _cutoffs_calibrated;
+
+inline size_t _envSize(const char * name)
+{
+    const char * value = std::getenv(name);
+    return value == nullptr ? 0 : std::strtoull(value, nullptr, 10);
+}
+
+template <class Func>
+size_t _medianNs(size_t repetitions, const Func & f)
+{
+    std::vector<size_t> times;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Times an empty run() on every participant of the default executor and a cheap element loop.
+// A part has to do four dispatches worth of work; ALG_MIN_PART_NS and ALG_MIN_PART_ELEMENTS override the probe.
+inline void _calibrateCutoffs()
+{
+    size_t partNs = alg::_envSize("ALG_MIN_PART_NS");
+    size_t partElements = alg::_envSize("ALG_MIN_PART_ELEMENTS");
+    if (partNs == 0 || partElements == 0)
+    {
+        alg::executor & ex = alg::default_executor();
+        size_t dispatchNs = alg::_medianNs(15, [&ex] { ex.run(ex.concurrency(), [](size_t) {}); });
+        std::vector<uint32_t> items(4096, 1);
+        volatile uint32_t sink = 0;
+        size_t loopNs = alg::_medianNs(15, [&]
+        {
+            for (uint32_t & item : items)
+                item = item * 2654435761u + 1;
+            sink = sink + items[items.size() / 2];
+        });
+        if (partNs == 0)
+            partNs = std::max<size_t>(1000, 4 * dispatchNs);
+        if (partElements == 0)
+            partElements = std::max<size_t>(256, partNs * items.size() / std::max<size_t>(1, loopNs));
+    }
+    size_t unset = 0;
+    alg::_min_part_ns.compare_exchange_strong(unset, partNs);
+    unset = 0;
+    alg::_min_part_elements.compare_exchange_strong(unset, partElements);
+}
+
+// Calibrated on first use unless set_cutoffs came first.
+inline alg::cutoff_thresholds cutoffs()
+{
+    if (alg::_min_part_ns == 0 || alg::_min_part_elements == 0)
+        std::call_once(alg::_cutoffs_calibrated, alg::_calibrateCutoffs);
+    return alg::cutoff_thresholds{alg::_min_part_ns, alg::_min_part_elements};
+}
+
+// Values are raised to at least 1, so set_cutoffs({1, 1}) always uses every participant.
+inline void set_cutoffs(const alg::cutoff_thresholds & thresholds)
+{
+    alg::_min_part_ns = std::max<size_t>(1, thresholds.min_part_ns);
+    alg::_min_part_elements = std::max<size_t>(1, thresholds.min_part_elements);
+}
+
+// Participants worth using for n cheap elements.
+inline size_t _partsFor(alg::executor & ex, size_t n)
+{
+    return std::max<size_t>(1, std::min(ex.concurrency(), n / alg::cutoffs().min_part_elements));
+}
+
+}
+
+#endif // ALGCUTOFF_HPP
@@ -0,0 +1,181 @@
+#ifndef ALGMEMORY_HPP
+#define ALGMEMORY_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "algThreads.hpp"
+
+namespace alg
+{
+
+// Below this many bytes per part splitting a memory operation costs more than it saves.
+constexpr size_t _memory_part_bytes = 1 << 16;
+
+template <class It, class T = typename std::iterator_traits<It>::value_type, class = void>
+struct _isContiguousIt : std::is_pointer<It> {};
+
+template <class It, class T>
+struct _isContiguousIt<It, T, typename std::enable_if<std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value>::type>
+{
+    constexpr static bool value = std::is_pointer<It>::value || std::is_same<It, typename std::vector<T>::iterator>::value ||
+                                  std::is_same<It, typename std::vector<T>::const_iterator>::value ||
+                                  std::is_same<It, typename alg::first_touch_vector<T>::iterator>::value ||
+                                  std::is_same<It, typename alg::first_touch_vector<T>::const_iterator>::value;
+};
+
+// Both ranges are plain arrays of the same trivially copyable type, so they can be copied as bytes.
+template <class InputIt, class OutputIt>
+struct _isBitwiseCopyable
+{
+    using T = typename std::iterator_traits<InputIt>::value_type;
+    constexpr static bool value = alg::_isContiguousIt<InputIt>::value && alg::_isContiguousIt<OutputIt>::value &&
+                                  std::is_same<T, typename std::iterator_traits<OutputIt>::value_type>::value &&
+                                  std::is_trivially_copyable<T>::value;
+};
+
+// As above, and equal values have equal bytes (no floating point, no padding, no user operator==).
+template <class It1, class It2>
+struct _isBitwiseComparable
+{
+    using T = typename std::iterator_traits<It1>::value_type;
+    constexpr static bool value = alg::_isBitwiseCopyable<It1, It2>::value &&
+                                  (std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value) &&
+                                  std::has_unique_object_representations<T>::value;
+};
+
+template <class It>
+auto _toPointer(const It & it)
+{
+    return std::addressof(*it);
+}
+
+inline size_t _lastLevelCacheSize()
+{
+    static const size_t size = []
+    {
+        long bytes = 0;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+        bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (bytes <= 0)
+            bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+        return bytes > 0 ? static_cast<size_t>(bytes) : size_t(32) << 20;
+    }();
+    return size;
+}
+
+inline size_t _memoryParts(alg::executor & ex, size_t bytes)
+{
+    return std::max<size_t>(1, std::min(ex.concurrency(), bytes / alg::_memory_part_bytes));
+}
+
+// Writes bigger than the last level cache would only evict it, so they go around it.
+inline bool _useStreamingStores(size_t bytes)
+{
+#if defined(__SSE2__)
+    return bytes > alg::_lastLevelCacheSize();
+#else
+    (void)bytes;
+    return false;
+#endif
+}
+
+// Writes bytes from a repeating 16 byte pattern, which has to line up with 16 byte aligned addresses.
+inline void _streamPattern(unsigned char * dst, const unsigned char * pattern, size_t bytes)
+{
+#if defined(__SSE2__)
+    size_t head = std::min(bytes, (16 - reinterpret_cast<uintptr_t>(dst) % 16) % 16);
+    std::memcpy(dst, pattern + reinterpret_cast<uintptr_t>(dst) % 16, head);
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pattern));
+    size_t i = head;
+    for (; i + 16 <= bytes; i += 16)
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + i), block);
+    std::memcpy(dst + i, pattern, bytes - i);
+    _mm_sfence();
+#else
+    for (size_t i = 0; i < bytes; ++i)
+        dst[i] = pattern[reinterpret_cast<uintptr_t>(dst + i) % 16];
+#endif
+}
+
+inline void _copyBytes(alg::executor & ex, void * dst, const void * src, size_t bytes)
+{
+    unsigned char * to = static_cast<unsigned char *>(dst);
+    const unsigned char * from = static_cast<const unsigned char *>(src);
+    // Overlapping ranges are only right when copied in one go.
+    if ((to < from + bytes) && (from < to + bytes))
+    {
+        std::memmove(to, from, bytes);
+        return;
+    }
+    // memcpy already switches to streaming stores for large copies and does it better than a plain SSE2 loop.
+    size_t parts = alg::_memoryParts(ex, bytes);
+    ex.run_owned(parts, [&](size_t i)
+    {
+        size_t begin = bytes / parts * i + std::min(i, bytes % parts);
+        size_t end = bytes / parts * (i + 1) + std::min(i + 1, bytes % parts);
+        std::memcpy(to + begin, from + begin, end - begin);
+    });
+}
+
+template <class T>
+void _fillValues(alg::executor & ex, T * dst, size_t n, const T & value)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, std::addressof(value), sizeof(T));
+    bool repeatedByte = std::all_of(bytes, bytes + sizeof(T), [&bytes](unsigned char byte) { return byte == bytes[0]; });
+    // A 16 byte pattern only lines up with aligned addresses when whole values tile it.
+    unsigned char pattern[16];
+    bool patterned = (16 % sizeof(T) == 0) && (reinterpret_cast<uintptr_t>(dst) % sizeof(T) == 0);
+    if (patterned)
+        for (size_t k = 0; k < 16; ++k)
+            pattern[k] = bytes[k % sizeof(T)];
+    size_t parts = alg::_memoryParts(ex, n * sizeof(T));
+    bool streaming = patterned && alg::_useStreamingStores(n * sizeof(T));
+    ex.run_owned(parts, [&](size_t i)
+    {
+        size_t begin = n / parts * i + std::min(i, n % parts);
+        size_t end = n / parts * (i + 1) + std::min(i + 1, n % parts);
+        if (streaming)
+            alg::_streamPattern(reinterpret_cast<unsigned char *>(dst + begin), pattern, (end - begin) * sizeof(T));
+        else if (repeatedByte)
+            std::memset(static_cast<void *>(dst + begin), bytes[0], (end - begin) * sizeof(T));
+        else
+            std::fill(dst + begin, dst + end, value);
+    });
+}
+
+// Compares in blocks so that a difference found by one part stops the others soon after.
+inline bool _equalBytes(alg::executor & ex, const void * first, const void * second, size_t bytes)
+{
+    const unsigned char * a = static_cast<const unsigned char *>(first);
+    const unsigned char * b = static_cast<const unsigned char *>(second);
+    size_t blocks = std::max<size_t>(1, bytes / alg::_memory_part_bytes);
+    std::atomic<bool> different(false);
+    ex.run(blocks, [&](size_t i)
+    {
+        if (different.load(std::memory_order_relaxed))
+            return;
+        size_t begin = bytes / blocks * i + std::min(i, bytes % blocks);
+        size_t end = bytes / blocks * (i + 1) + std::min(i + 1, bytes % blocks);
+        if (std::memcmp(a + begin, b + begin, end - begin) != 0)
+            different.store(true, std::memory_order_relaxed);
+    });
+    return !different;
+}
+
+}
+
+#endif // ALGMEMORY_HPP
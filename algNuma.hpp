@@ -0,0 +1,205 @@
+#ifndef ALGNUMA_HPP
+#define ALGNUMA_HPP
+#include <cstddef>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// The topology is read from /sys, so there is no dependency on libnuma. Memory goes to the node of the
+// thread that touches it first, which is why the helpers below leave that touch to the workers.
+namespace alg
+{
+
+struct numa_node
+{
+    size_t id;
+    // CPUs of the node this process may run on.
+    std::vector<size_t> cpus;
+};
+
+// How executor workers are pinned: not at all, filling one node before the next, or round robin over the nodes.
+enum class affinity
+{
+    none,
+    compact,
+    spread
+};
+
+// Parses lists like "0-3,8,10-11" as used by /sys.
+inline std::vector<size_t> _parseCpuList(const std::string & list)
+{
+    std::vector<size_t> res;
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos)
+            end = list.size();
+        std::string item = list.substr(pos, end - pos);
+        size_t dash = item.find('-');
+        try
+        {
+            size_t first = std::stoul(item.substr(0, dash));
+            size_t last = dash == std::string::npos ? first : std::stoul(item.substr(dash + 1));
+            for (size_t cpu = first; cpu <= last; ++cpu)
+                res.push_back(cpu);
+        }
+        catch (const std::exception &)
+        {
+        }
+        pos = end + 1;
+    }
+    return res;
+}
+
+inline bool _readLine(const std::string & path, std::string & line)
+{
+    std::ifstream file(path);
+    return static_cast<bool>(std::getline(file, line));
+}
+
+inline std::vector<size_t> _allowedCpus()
+{
+    std::vector<size_t> res;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                res.push_back(cpu);
+#endif
+    if (res.empty())
+        for (size_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+            res.push_back(cpu);
+    return res;
+}
+
+inline std::vector<alg::numa_node> _probeTopology()
+{
+    std::vector<size_t> allowed = alg::_allowedCpus();
+    std::vector<alg::numa_node> res;
+    std::string line;
+    if (alg::_readLine("/sys/devices/system/node/online", line))
+    {
+        for (size_t id : alg::_parseCpuList(line))
+        {
+            if (!alg::_readLine("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist", line))
+                continue;
+            alg::numa_node node{id, {}};
+            for (size_t cpu : alg::_parseCpuList(line))
+                if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+                    node.cpus.push_back(cpu);
+            // Nodes with memory only, or with none of our CPUs, have nobody to place there.
+            if (!node.cpus.empty())
+                res.push_back(std::move(node));
+        }
+    }
+    if (res.empty())
+        res.push_back(alg::numa_node{0, std::move(allowed)});
+    return res;
+}
+
+// Nodes with at least one CPU this process may run on, probed once; a single node when /sys has no topology.
+inline const std::vector<alg::numa_node> & numa_topology()
+{
+    static const std::vector<alg::numa_node> topology = alg::_probeTopology();
+    return topology;
+}
+
+// Returns false where pinning is not supported or the CPU is not available.
+inline bool pin_this_thread(size_t cpu)
+{
+#if defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// CPU for each of count participants, wrapping around when there are more participants than CPUs.
+inline std::vector<size_t> _placement(alg::affinity policy, size_t count)
+{
+    std::vector<size_t> order;
+    if (policy == alg::affinity::none)
+        return order;
+    const std::vector<alg::numa_node> & nodes = alg::numa_topology();
+    if (policy == alg::affinity::compact)
+    {
+        for (const alg::numa_node & node : nodes)
+            order.insert(order.end(), node.cpus.begin(), node.cpus.end());
+    }
+    else
+    {
+        for (size_t k = 0; order.size() < count; ++k)
+        {
+            size_t before = order.size();
+            for (const alg::numa_node & node : nodes)
+                if (k < node.cpus.size())
+                    order.push_back(node.cpus[k]);
+            if (order.size() == before)
+                break;
+        }
+    }
+    std::vector<size_t> res(count);
+    for (size_t i = 0; i < count; ++i)
+        res[i] = order[i % order.size()];
+    return res;
+}
+
+// Leaves trivially constructible elements untouched on construction, so that a
+// std::vector<T, alg::first_touch_allocator<T>> of size n only gets its pages once
+// alg::first_touch_fill writes them from the workers that will use them.
+template <class T>
+class first_touch_allocator
+{
+public:
+    using value_type = T;
+
+    first_touch_allocator() = default;
+    template <class U>
+    first_touch_allocator(const alg::first_touch_allocator<U> &) {}
+
+    T * allocate(size_t n) { return std::allocator<T>().allocate(n); }
+    void deallocate(T * p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <class U>
+    void construct(U * p) { ::new (static_cast<void *>(p)) U; }
+    template <class U, class... Args>
+    void construct(U * p, Args &&... args) { ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+};
+
+template <class T, class U>
+bool operator==(const alg::first_touch_allocator<T> &, const alg::first_touch_allocator<U> &)
+{
+    return true;
+}
+
+template <class T, class U>
+bool operator!=(const alg::first_touch_allocator<T> &, const alg::first_touch_allocator<U> &)
+{
+    return false;
+}
+
+template <class T>
+using first_touch_vector = std::vector<T, alg::first_touch_allocator<T>>;
+
+}
+
+#endif // ALGNUMA_HPP
@@ -0,0 +1,369 @@
+#ifndef ALGPIPE_HPP
+#define ALGPIPE_HPP
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "alg.hpp"
+
+// alg::pipe(range) | alg::map(f) | alg::filter(p) | alg::reduce(init, op) runs the whole chain over each
+// chunk in one pass, without a buffer between the stages. map and filter only describe the chain; it runs
+// when one of alg::reduce, alg::count, alg::for_each or alg::copy_into is appended.
+namespace alg
+{
+
+template <class Func>
+struct _PipeMap
+{
+    Func f;
+};
+
+template <class Func>
+struct _PipeFilter
+{
+    Func f;
+};
+
+// T is void when the reduction has no initial value.
+template <class T, class Func>
+struct _PipeReduce
+{
+    std::optional<typename std::conditional<std::is_void<T>::value, char, T>::type> init;
+    Func f;
+};
+
+struct _PipeCount
+{
+};
+
+template <class Func>
+struct _PipeForEach
+{
+    Func f;
+};
+
+template <class OutputIt>
+struct _PipeCopy
+{
+    OutputIt d_first;
+};
+
+template <class It, class... Stages>
+struct _Pipe
+{
+    alg::executor * ex;
+    It first;
+    It last;
+    std::tuple<Stages...> stages;
+};
+
+template <class Stage>
+struct _isPipeFilter
+{
+    constexpr static bool value = false;
+};
+
+template <class Func>
+struct _isPipeFilter<alg::_PipeFilter<Func>>
+{
+    constexpr static bool value = true;
+};
+
+// Type of what comes out of the chain when T goes in.
+template <class T, class... Stages>
+struct _PipeValue
+{
+    using type = typename std::decay<T>::type;
+};
+
+template <class T, class Func, class... Stages>
+struct _PipeValue<T, alg::_PipeMap<Func>, Stages...> : alg::_PipeValue<std::invoke_result_t<const Func &, T>, Stages...>
+{
+};
+
+template <class T, class Func, class... Stages>
+struct _PipeValue<T, alg::_PipeFilter<Func>, Stages...> : alg::_PipeValue<T, Stages...>
+{
+};
+
+template <class It, class... Stages>
+using _pipeValue = typename alg::_PipeValue<decltype(*std::declval<It &>()), Stages...>::type;
+
+template <class It>
+alg::_Pipe<It> pipe(alg::executor & ex, It first, It last)
+{
+    return alg::_Pipe<It>{&ex, first, last, std::tuple<>()};
+}
+
+template <class It>
+alg::_Pipe<It> pipe(It first, It last)
+{
+    return alg::pipe(alg::default_executor(), first, last);
+}
+
+// The range has to outlive the pipeline.
+template <class Range>
+auto pipe(alg::executor & ex, Range & range)
+{
+    return alg::pipe(ex, std::begin(range), std::end(range));
+}
+
+template <class Range>
+auto pipe(Range & range)
+{
+    return alg::pipe(alg::default_executor(), range);
+}
+
+template <class Func>
+alg::_PipeMap<Func> map(Func f)
+{
+    return alg::_PipeMap<Func>{std::move(f)};
+}
+
+template <class Func>
+alg::_PipeFilter<Func> filter(Func f)
+{
+    return alg::_PipeFilter<Func>{std::move(f)};
+}
+
+// As with alg::reduce, op has to be associative and commutative. Without init an empty result is T().
+template <class Func>
+alg::_PipeReduce<void, Func> reduce(Func op)
+{
+    return alg::_PipeReduce<void, Func>{std::nullopt, std::move(op)};
+}
+
+template <class T, class Func>
+alg::_PipeReduce<T, Func> reduce(T init, Func op)
+{
+    return alg::_PipeReduce<T, Func>{std::move(init), std::move(op)};
+}
+
+inline alg::_PipeCount count()
+{
+    return alg::_PipeCount();
+}
+
+template <class Func>
+alg::_PipeForEach<Func> for_each(Func f)
+{
+    return alg::_PipeForEach<Func>{std::move(f)};
+}
+
+// Returns the end of what was written. Chains with a filter run twice, the first time only to count.
+template <class OutputIt>
+alg::_PipeCopy<OutputIt> copy_into(OutputIt d_first)
+{
+    return alg::_PipeCopy<OutputIt>{d_first};
+}
+
+template <class It, class... Stages, class Func>
+alg::_Pipe<It, Stages..., alg::_PipeMap<Func>> operator|(const alg::_Pipe<It, Stages...> & pipe, alg::_PipeMap<Func> stage)
+{
+    return {pipe.ex, pipe.first, pipe.last, std::tuple_cat(pipe.stages, std::make_tuple(std::move(stage)))};
+}
+
+template <class It, class... Stages, class Func>
+alg::_Pipe<It, Stages..., alg::_PipeFilter<Func>> operator|(const alg::_Pipe<It, Stages...> & pipe, alg::_PipeFilter<Func> stage)
+{
+    return {pipe.ex, pipe.first, pipe.last, std::tuple_cat(pipe.stages, std::make_tuple(std::move(stage)))};
+}
+
+// Passes item through stage I and the ones after it, and hands whatever is left to sink.
+template <size_t I, class Stages, class Sink, class T>
+void _pipePush(const Stages & stages, Sink & sink, T && item)
+{
+    if constexpr (I == std::tuple_size<Stages>::value)
+    {
+        sink(std::forward<T>(item));
+    }
+    else if constexpr (alg::_isPipeFilter<typename std::tuple_element<I, Stages>::type>::value)
+    {
+        if (std::get<I>(stages).f(item))
+            alg::_pipePush<I + 1>(stages, sink, std::forward<T>(item));
+    }
+    else
+    {
+        alg::_pipePush<I + 1>(stages, sink, std::get<I>(stages).f(std::forward<T>(item)));
+    }
+}
+
+template <class It, class Stages, class Sink>
+void _inThreadPipe(It first, const It & last, const Stages & stages, Sink & sink)
+{
+    for (; first != last; ++first)
+        alg::_pipePush<0>(stages, sink, *first);
+}
+
+// Calls body(part, first, last) for the chunks of the range; part is below ex.concurrency(). A single-pass
+// range is read once, through the stream ring, and its chunks are the batches.
+template <class It, class Body>
+alg::_ifRAIt<It, void> _pipeChunks(alg::executor & ex, const It & first, const It & last, const Body & body)
+{
+    alg::_stealingFor(ex, last - first, [&](size_t part, size_t begin, size_t end)
+    {
+        body(part, first + begin, first + end);
+    });
+}
+
+template <class It, class Body>
+alg::_ifnotRAIt<It, void> _pipeChunks(alg::executor & ex, const It & first, const It & last, const Body & body)
+{
+    if constexpr (alg::_isInputOnly<It>::value)
+    {
+        using V = typename std::iterator_traits<It>::value_type;
+        It current = first;
+        alg::_IteratorSource<It> source{current, last};
+        alg::_stream<false, V>(ex, source, [&body](size_t part, size_t, std::vector<V> & items)
+        {
+            body(part, items.begin(), items.end());
+        }, nullptr);
+    }
+    else
+    {
+        alg::_Scratch<It> splited = alg::_split(first, last, ex.concurrency());
+        ex.run(ex.concurrency(), [&](size_t i)
+        {
+            body(i, splited[i], splited[i + 1]);
+        });
+    }
+}
+
+template <class It, class... Stages, class T, class Func>
+auto operator|(const alg::_Pipe<It, Stages...> & pipe, const alg::_PipeReduce<T, Func> & stage)
+{
+    alg::_CallScope scope("pipe_reduce");
+    using V = typename std::conditional<std::is_void<T>::value, alg::_pipeValue<It, Stages...>, T>::type;
+    alg::executor & ex = *pipe.ex;
+    alg::_Scratch<alg::_ReduceSlot<V>> slots(ex.concurrency());
+    alg::_pipeChunks(ex, pipe.first, pipe.last, [&](size_t part, const auto & first, const auto & last)
+    {
+        std::optional<V> partial;
+        auto sink = [&](auto && item)
+        {
+            if (partial)
+                partial = stage.f(std::move(*partial), std::forward<decltype(item)>(item));
+            else
+                partial = std::forward<decltype(item)>(item);
+        };
+        alg::_inThreadPipe(first, last, pipe.stages, sink);
+        if (partial)
+            alg::_mergeIntoSlot(slots[part], std::move(*partial), stage.f);
+    });
+    std::optional<V> res;
+    if constexpr (!std::is_void<T>::value)
+        res = *stage.init;
+    for (size_t i = 0; i < ex.concurrency(); ++i)
+        if (slots[i].value)
+        {
+            if (res)
+                res = stage.f(std::move(*res), std::move(*slots[i].value));
+            else
+                res = std::move(*slots[i].value);
+        }
+    return res ? std::move(*res) : V();
+}
+
+template <class It, class... Stages>
+typename std::iterator_traits<It>::difference_type operator|(const alg::_Pipe<It, Stages...> & pipe, alg::_PipeCount)
+{
+    alg::_CallScope scope("pipe_count");
+    using Diff = typename std::iterator_traits<It>::difference_type;
+    alg::executor & ex = *pipe.ex;
+    alg::_Scratch<alg::_ReduceSlot<Diff>> slots(ex.concurrency());
+    alg::_pipeChunks(ex, pipe.first, pipe.last, [&](size_t part, const auto & first, const auto & last)
+    {
+        Diff count = 0;
+        auto sink = [&count](auto &&) { ++count; };
+        alg::_inThreadPipe(first, last, pipe.stages, sink);
+        alg::_mergeIntoSlot(slots[part], std::move(count), std::plus<>());
+    });
+    Diff res = alg::_reduceSlots(slots.get(), ex.concurrency(), Diff(0), std::plus<>());
+    return res;
+}
+
+template <class It, class... Stages, class Func>
+void operator|(const alg::_Pipe<It, Stages...> & pipe, const alg::_PipeForEach<Func> & stage)
+{
+    alg::_CallScope scope("pipe_for_each");
+    alg::_pipeChunks(*pipe.ex, pipe.first, pipe.last, [&](size_t, const auto & first, const auto & last)
+    {
+        auto sink = [&stage](auto && item) { stage.f(std::forward<decltype(item)>(item)); };
+        alg::_inThreadPipe(first, last, pipe.stages, sink);
+    });
+}
+
+// Without a filter an RA source writes every chunk at its own offset in one pass. Otherwise, as in
+// _compact, the first pass counts what every chunk keeps and the second writes it from its offset.
+// Outputs that are not random access and single-pass sources run serially.
+template <class It, class... Stages, class OutputIt>
+OutputIt operator|(const alg::_Pipe<It, Stages...> & pipe, const alg::_PipeCopy<OutputIt> & stage)
+{
+    alg::_CallScope scope("pipe_copy_into");
+    constexpr bool randomAccessOutput = std::is_same<typename std::iterator_traits<OutputIt>::iterator_category,
+                                                     std::random_access_iterator_tag>::value;
+    constexpr bool randomAccessInput = std::is_same<typename std::iterator_traits<It>::iterator_category,
+                                                    std::random_access_iterator_tag>::value;
+    alg::executor & ex = *pipe.ex;
+    OutputIt out = stage.d_first;
+    auto sink = [&out](auto && item)
+    {
+        *out = std::forward<decltype(item)>(item);
+        ++out;
+    };
+    if constexpr (!randomAccessOutput || alg::_isInputOnly<It>::value)
+    {
+        alg::_inThreadPipe(pipe.first, pipe.last, pipe.stages, sink);
+        return out;
+    }
+    else if constexpr (randomAccessInput && !(alg::_isPipeFilter<Stages>::value || ...))
+    {
+        alg::_stealingFor(ex, pipe.last - pipe.first, [&](size_t, size_t begin, size_t end)
+        {
+            OutputIt chunkOut = stage.d_first + begin;
+            auto chunkSink = [&chunkOut](auto && item)
+            {
+                *chunkOut = std::forward<decltype(item)>(item);
+                ++chunkOut;
+            };
+            alg::_inThreadPipe(pipe.first + begin, pipe.first + end, pipe.stages, chunkSink);
+        });
+        return stage.d_first + (pipe.last - pipe.first);
+    }
+    else
+    {
+        size_t parts = alg::_partsFor(ex, pipe.first, pipe.last);
+        alg::_Scratch<It> splited = alg::_split(pipe.first, pipe.last, parts);
+        alg::_Scratch<size_t> offsets(parts + 1);
+        offsets[0] = 0;
+        ex.run_owned(parts, [&](size_t i)
+        {
+            size_t count = 0;
+            auto countSink = [&count](auto &&) { ++count; };
+            alg::_inThreadPipe(splited[i], splited[i + 1], pipe.stages, countSink);
+            offsets[i + 1] = count;
+            alg::_countRange(splited[i], splited[i + 1]);
+        });
+        std::partial_sum(offsets.get(), offsets.get() + parts + 1, offsets.get());
+        ex.run_owned(parts, [&](size_t i)
+        {
+            OutputIt chunkOut = stage.d_first + offsets[i];
+            auto chunkSink = [&chunkOut](auto && item)
+            {
+                *chunkOut = std::forward<decltype(item)>(item);
+                ++chunkOut;
+            };
+            alg::_inThreadPipe(splited[i], splited[i + 1], pipe.stages, chunkSink);
+        });
+        out += offsets[parts];
+        return out;
+    }
+}
+
+}
+
+#endif // ALGPIPE_HPP
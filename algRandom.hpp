@@ -0,0 +1,91 @@
+#ifndef ALGRANDOM_HPP
+#define ALGRANDOM_HPP
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <limits>
+
+// Counter-based random numbers: Philox4x32-10 from Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3". A block of four numbers is a keyed bijection of a 128-bit counter, so the numbers of any
+// position can be computed without the ones before it, and a parallel fill that gives element i its own
+// sequence is the same on any number of threads.
+namespace alg
+{
+
+class philox4x32
+{
+public:
+    using result_type = uint32_t;
+
+    // The counter is (draw, stream): stream picks one of 2^64 independent sequences of the seed.
+    explicit philox4x32(uint64_t seed = 0, uint64_t stream = 0);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+    result_type operator()();
+
+    static std::array<uint32_t, 4> block(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key);
+
+    // Four engines on stream of seed, engine i returning only number i of every block: four sequences that
+    // never overlap, whose first numbers all come from one block.
+    static std::array<philox4x32, 4> lanes(uint64_t seed, uint64_t stream);
+private:
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> counter;
+    std::array<uint32_t, 4> buffer;
+    size_t used;
+    // The numbers of a block that are returned.
+    size_t begin;
+    size_t end;
+};
+
+inline alg::philox4x32::philox4x32(uint64_t seed, uint64_t stream)
+    : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)},
+      counter{0, 0, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)}, buffer{}, used(4), begin(0), end(4)
+{
+}
+
+inline std::array<uint32_t, 4> alg::philox4x32::block(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key)
+{
+    for (size_t round = 0; round < 10; ++round)
+    {
+        uint64_t product0 = uint64_t(0xD2511F53) * counter[0];
+        uint64_t product1 = uint64_t(0xCD9E8D57) * counter[2];
+        counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                   static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+        key[0] += 0x9E3779B9;
+        key[1] += 0xBB67AE85;
+    }
+    return counter;
+}
+
+inline std::array<alg::philox4x32, 4> alg::philox4x32::lanes(uint64_t seed, uint64_t stream)
+{
+    alg::philox4x32 engine(seed, stream);
+    engine.buffer = alg::philox4x32::block(engine.counter, engine.key);
+    engine.counter[0] = 1;
+    std::array<alg::philox4x32, 4> res{engine, engine, engine, engine};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        res[i].used = i;
+        res[i].begin = i;
+        res[i].end = i + 1;
+    }
+    return res;
+}
+
+inline alg::philox4x32::result_type alg::philox4x32::operator()()
+{
+    if (used == end)
+    {
+        buffer = alg::philox4x32::block(counter, key);
+        used = begin;
+        if (++counter[0] == 0)
+            ++counter[1];
+    }
+    return buffer[used++];
+}
+
+}
+
+#endif // ALGRANDOM_HPP
@@ -0,0 +1,145 @@
+#ifndef ALGSCRATCH_HPP
+#define ALGSCRATCH_HPP
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Partition bounds, result slots and stealing deques live only as long as one call. Their memory comes from
+// a small per-thread cache of blocks, so once a thread has made a few calls the dispatch path no longer
+// touches the heap.
+namespace alg
+{
+
+constexpr size_t _scratch_alignment = 64;
+
+class _ScratchCache
+{
+private:
+    static constexpr size_t capacity = 32;
+    void * blocks[capacity];
+    size_t sizes[capacity];
+    size_t count;
+public:
+    _ScratchCache() : count(0) {}
+    ~_ScratchCache();
+    _ScratchCache(const _ScratchCache &) = delete;
+    _ScratchCache & operator=(const _ScratchCache &) = delete;
+
+    void * take(size_t & size);
+    void give(void * block, size_t size);
+};
+
+inline alg::_ScratchCache::~_ScratchCache()
+{
+    for (size_t i = 0; i < count; ++i)
+        ::operator delete(blocks[i], std::align_val_t(alg::_scratch_alignment));
+}
+
+// Hands out the smallest cached block of at least size bytes, or a new one; size becomes the block size.
+inline void * alg::_ScratchCache::take(size_t & size)
+{
+    size_t best = count;
+    for (size_t i = 0; i < count; ++i)
+        if ((sizes[i] >= size) && ((best == count) || (sizes[i] < sizes[best])))
+            best = i;
+    if (best == count)
+    {
+        size_t rounded = 256;
+        while (rounded < size)
+            rounded *= 2;
+        size = rounded;
+        return ::operator new(size, std::align_val_t(alg::_scratch_alignment));
+    }
+    void * res = blocks[best];
+    size = sizes[best];
+    --count;
+    blocks[best] = blocks[count];
+    sizes[best] = sizes[count];
+    return res;
+}
+
+// A full cache drops its smallest block to keep the larger one.
+inline void alg::_ScratchCache::give(void * block, size_t size)
+{
+    if (count == capacity)
+    {
+        size_t smallest = 0;
+        for (size_t i = 1; i < count; ++i)
+            if (sizes[i] < sizes[smallest])
+                smallest = i;
+        if (sizes[smallest] >= size)
+        {
+            ::operator delete(block, std::align_val_t(alg::_scratch_alignment));
+            return;
+        }
+        ::operator delete(blocks[smallest], std::align_val_t(alg::_scratch_alignment));
+        blocks[smallest] = block;
+        sizes[smallest] = size;
+        return;
+    }
+    blocks[count] = block;
+    sizes[count] = size;
+    ++count;
+}
+
+inline thread_local alg::_ScratchCache _scratch_cache;
+
+// n default-initialised elements that go back to the cache of the thread that destroys them.
+template <class T>
+class _Scratch
+{
+private:
+    T * items;
+    size_t n;
+    size_t bytes;
+public:
+    explicit _Scratch(size_t n);
+    _Scratch(_Scratch && other) : items(other.items), n(other.n), bytes(other.bytes) { other.items = nullptr; }
+    ~_Scratch();
+    _Scratch(const _Scratch &) = delete;
+    _Scratch & operator=(const _Scratch &) = delete;
+    _Scratch & operator=(_Scratch &&) = delete;
+
+    T * get() const { return items; }
+    size_t size() const { return n; }
+    T & operator[](size_t i) const { return items[i]; }
+};
+
+template <class T>
+alg::_Scratch<T>::_Scratch(size_t n) : n(n), bytes(n * sizeof(T))
+{
+    static_assert(alignof(T) <= alg::_scratch_alignment, "alg: scratch elements are aligned to at most 64 bytes");
+    if (n == 0)
+    {
+        items = nullptr;
+        return;
+    }
+    items = static_cast<T *>(alg::_scratch_cache.take(bytes));
+    size_t built = 0;
+    try
+    {
+        for (; built < n; ++built)
+            ::new (static_cast<void *>(items + built)) T;
+    }
+    catch (...)
+    {
+        while (built != 0)
+            items[--built].~T();
+        alg::_scratch_cache.give(items, bytes);
+        throw;
+    }
+}
+
+template <class T>
+alg::_Scratch<T>::~_Scratch()
+{
+    if (items == nullptr)
+        return;
+    for (size_t i = 0; i < n; ++i)
+        items[i].~T();
+    alg::_scratch_cache.give(items, bytes);
+}
+
+}
+
+#endif // ALGSCRATCH_HPP
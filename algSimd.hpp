@@ -0,0 +1,532 @@
+#ifndef ALGSIMD_HPP
+#define ALGSIMD_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include "algMemory.hpp"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && !defined(ALG_NO_SIMD)
+#define ALG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Value comparison kernels for contiguous arithmetic elements. Every worker runs them on its own chunk;
+// the instruction set is picked once at run time, SSE2 being the x86 baseline, and ALG_SIMD_LEVEL
+// (0 scalar, 1 SSE2, 2 AVX2, 3 AVX-512) caps it.
+namespace alg
+{
+
+template <class T>
+struct _isSimdElement
+{
+    constexpr static bool value = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                                  (std::is_integral<T>::value ? (sizeof(T) <= 8 && (sizeof(T) & (sizeof(T) - 1)) == 0)
+                                                              : (std::is_same<T, float>::value || std::is_same<T, double>::value));
+};
+
+template <class It>
+struct _isSimdRange
+{
+    using T = typename std::iterator_traits<It>::value_type;
+    constexpr static bool value = alg::_isContiguousIt<It>::value && alg::_isSimdElement<T>::value;
+};
+
+// The kernels compare elements with item converted to their type, which finds the same elements as
+// element == item only when the converted value still compares equal to item under ==, with its usual
+// arithmetic conversions: a signed char -1 becomes 0xFF for uint8_t data, but no uint8_t equals -1.
+template <class T, class U>
+bool _simdValue(const U & item, T & value)
+{
+    if constexpr (std::is_same<T, U>::value)
+    {
+        value = item;
+        return true;
+    }
+    else if constexpr (std::is_integral<T>::value && std::is_integral<U>::value)
+    {
+        using C = typename std::common_type<T, U>::type;
+        value = static_cast<T>(item);
+        return static_cast<C>(value) == static_cast<C>(item);
+    }
+    else
+        return false;
+}
+
+inline int _detectSimdLevel()
+{
+#if defined(ALG_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return 3;
+    if (__builtin_cpu_supports("avx2"))
+        return 2;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+inline int _simdLevel()
+{
+    static const int level = []
+    {
+        int detected = alg::_detectSimdLevel();
+        const char * cap = std::getenv("ALG_SIMD_LEVEL");
+        if ((cap != nullptr) && (*cap != '\0'))
+            detected = std::clamp(std::atoi(cap), 0, detected);
+        return detected;
+    }();
+    return level;
+}
+
+template <class T>
+size_t _scalarFind(const T * data, size_t n, T value)
+{
+    return std::find(data, data + n, value) - data;
+}
+
+template <class T>
+size_t _scalarCount(const T * data, size_t n, T value)
+{
+    return std::count(data, data + n, value);
+}
+
+template <class T>
+size_t _scalarMismatch(const T * first, const T * second, size_t n)
+{
+    return std::mismatch(first, first + n, second).first - first;
+}
+
+template <class T>
+void _scalarReplace(T * data, size_t n, T oldValue, T newValue)
+{
+    std::replace(data, data + n, oldValue, newValue);
+}
+
+#if defined(ALG_SIMD_X86)
+
+// Masks of equal elements come out of movemask with one bit per byte.
+struct _Sse2
+{
+    template <class T>
+    static __m128i broadcast(T value);
+    template <class T>
+    static __m128i equal(__m128i a, __m128i b);
+
+    template <class T>
+    static size_t find(const T * data, size_t n, T value);
+    template <class T>
+    static size_t count(const T * data, size_t n, T value);
+    template <class T>
+    static size_t mismatch(const T * first, const T * second, size_t n);
+    template <class T>
+    static void replace(T * data, size_t n, T oldValue, T newValue);
+};
+
+template <class T>
+__m128i alg::_Sse2::broadcast(T value)
+{
+    T lanes[16 / sizeof(T)];
+    std::fill(lanes, lanes + 16 / sizeof(T), value);
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes));
+}
+
+template <class T>
+__m128i alg::_Sse2::equal(__m128i a, __m128i b)
+{
+    if constexpr (std::is_same<T, float>::value)
+        return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+    else if constexpr (std::is_same<T, double>::value)
+        return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+    else if constexpr (sizeof(T) == 1)
+        return _mm_cmpeq_epi8(a, b);
+    else if constexpr (sizeof(T) == 2)
+        return _mm_cmpeq_epi16(a, b);
+    else if constexpr (sizeof(T) == 4)
+        return _mm_cmpeq_epi32(a, b);
+    else
+    {
+        // No 64 bit compare before SSE4.1: both halves have to be equal.
+        __m128i halves = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+}
+
+template <class T>
+size_t alg::_Sse2::find(const T * data, size_t n, T value)
+{
+    constexpr size_t lanes = 16 / sizeof(T);
+    __m128i item = alg::_Sse2::broadcast(value);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        unsigned mask = _mm_movemask_epi8(alg::_Sse2::equal<T>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), item));
+        if (mask != 0)
+            return i + __builtin_ctz(mask) / sizeof(T);
+    }
+    return i + alg::_scalarFind(data + i, n - i, value);
+}
+
+// Subtracting an all ones compare result counts every equal element sizeof(T) times in byte counters,
+// which are summed up before they can wrap.
+template <class T>
+size_t alg::_Sse2::count(const T * data, size_t n, T value)
+{
+    constexpr size_t lanes = 16 / sizeof(T);
+    __m128i item = alg::_Sse2::broadcast(value);
+    __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    size_t i = 0;
+    while (i + lanes <= n)
+    {
+        __m128i counters = zero;
+        for (size_t round = 0; (round < 255) && (i + lanes <= n); ++round, i += lanes)
+            counters = _mm_sub_epi8(counters, alg::_Sse2::equal<T>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), item));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(counters, zero));
+    }
+    uint64_t halves[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(halves), sums);
+    return (halves[0] + halves[1]) / sizeof(T) + alg::_scalarCount(data + i, n - i, value);
+}
+
+template <class T>
+size_t alg::_Sse2::mismatch(const T * first, const T * second, size_t n)
+{
+    constexpr size_t lanes = 16 / sizeof(T);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        unsigned mask = _mm_movemask_epi8(alg::_Sse2::equal<T>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i)),
+                                                               _mm_loadu_si128(reinterpret_cast<const __m128i *>(second + i))));
+        if (mask != 0xffff)
+            return i + __builtin_ctz(~mask) / sizeof(T);
+    }
+    return i + alg::_scalarMismatch(first + i, second + i, n - i);
+}
+
+// Vectors without a match are not written back.
+template <class T>
+void alg::_Sse2::replace(T * data, size_t n, T oldValue, T newValue)
+{
+    constexpr size_t lanes = 16 / sizeof(T);
+    __m128i from = alg::_Sse2::broadcast(oldValue);
+    __m128i to = alg::_Sse2::broadcast(newValue);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        __m128i items = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i mask = alg::_Sse2::equal<T>(items, from);
+        if (_mm_movemask_epi8(mask) != 0)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_or_si128(_mm_andnot_si128(mask, items), _mm_and_si128(mask, to)));
+    }
+    alg::_scalarReplace(data + i, n - i, oldValue, newValue);
+}
+
+// Same scheme as _Sse2 on 32 byte vectors.
+struct _Avx2
+{
+    template <class T>
+    static __m256i broadcast(T value) __attribute__((target("avx2")));
+    template <class T>
+    static __m256i equal(__m256i a, __m256i b) __attribute__((target("avx2")));
+
+    template <class T>
+    static size_t find(const T * data, size_t n, T value) __attribute__((target("avx2")));
+    template <class T>
+    static size_t count(const T * data, size_t n, T value) __attribute__((target("avx2")));
+    template <class T>
+    static size_t mismatch(const T * first, const T * second, size_t n) __attribute__((target("avx2")));
+    template <class T>
+    static void replace(T * data, size_t n, T oldValue, T newValue) __attribute__((target("avx2")));
+};
+
+template <class T>
+__attribute__((target("avx2"))) __m256i alg::_Avx2::broadcast(T value)
+{
+    T lanes[32 / sizeof(T)];
+    std::fill(lanes, lanes + 32 / sizeof(T), value);
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lanes));
+}
+
+template <class T>
+__attribute__((target("avx2"))) __m256i alg::_Avx2::equal(__m256i a, __m256i b)
+{
+    if constexpr (std::is_same<T, float>::value)
+        return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+    else if constexpr (std::is_same<T, double>::value)
+        return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+    else if constexpr (sizeof(T) == 1)
+        return _mm256_cmpeq_epi8(a, b);
+    else if constexpr (sizeof(T) == 2)
+        return _mm256_cmpeq_epi16(a, b);
+    else if constexpr (sizeof(T) == 4)
+        return _mm256_cmpeq_epi32(a, b);
+    else
+        return _mm256_cmpeq_epi64(a, b);
+}
+
+template <class T>
+__attribute__((target("avx2"))) size_t alg::_Avx2::find(const T * data, size_t n, T value)
+{
+    constexpr size_t lanes = 32 / sizeof(T);
+    __m256i item = alg::_Avx2::broadcast(value);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        unsigned mask = _mm256_movemask_epi8(alg::_Avx2::equal<T>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), item));
+        if (mask != 0)
+            return i + __builtin_ctz(mask) / sizeof(T);
+    }
+    return i + alg::_scalarFind(data + i, n - i, value);
+}
+
+template <class T>
+__attribute__((target("avx2"))) size_t alg::_Avx2::count(const T * data, size_t n, T value)
+{
+    constexpr size_t lanes = 32 / sizeof(T);
+    __m256i item = alg::_Avx2::broadcast(value);
+    __m256i zero = _mm256_setzero_si256();
+    __m256i sums = zero;
+    size_t i = 0;
+    while (i + lanes <= n)
+    {
+        __m256i counters = zero;
+        for (size_t round = 0; (round < 255) && (i + lanes <= n); ++round, i += lanes)
+            counters = _mm256_sub_epi8(counters, alg::_Avx2::equal<T>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), item));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counters, zero));
+    }
+    uint64_t quarters[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(quarters), sums);
+    return (quarters[0] + quarters[1] + quarters[2] + quarters[3]) / sizeof(T) + alg::_scalarCount(data + i, n - i, value);
+}
+
+template <class T>
+__attribute__((target("avx2"))) size_t alg::_Avx2::mismatch(const T * first, const T * second, size_t n)
+{
+    constexpr size_t lanes = 32 / sizeof(T);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        unsigned mask = _mm256_movemask_epi8(alg::_Avx2::equal<T>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i)),
+                                                                  _mm256_loadu_si256(reinterpret_cast<const __m256i *>(second + i))));
+        if (mask != 0xffffffffu)
+            return i + __builtin_ctz(~mask) / sizeof(T);
+    }
+    return i + alg::_scalarMismatch(first + i, second + i, n - i);
+}
+
+template <class T>
+__attribute__((target("avx2"))) void alg::_Avx2::replace(T * data, size_t n, T oldValue, T newValue)
+{
+    constexpr size_t lanes = 32 / sizeof(T);
+    __m256i from = alg::_Avx2::broadcast(oldValue);
+    __m256i to = alg::_Avx2::broadcast(newValue);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        __m256i items = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i mask = alg::_Avx2::equal<T>(items, from);
+        if (_mm256_movemask_epi8(mask) != 0)
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i), _mm256_blendv_epi8(items, to, mask));
+    }
+    alg::_scalarReplace(data + i, n - i, oldValue, newValue);
+}
+
+// AVX-512 compares straight into mask registers, with one bit per element.
+struct _Avx512
+{
+    template <class T>
+    static __m512i broadcast(T value) __attribute__((target("avx512f,avx512bw")));
+    template <class T>
+    static uint64_t equal(__m512i a, __m512i b) __attribute__((target("avx512f,avx512bw")));
+
+    template <class T>
+    static size_t find(const T * data, size_t n, T value) __attribute__((target("avx512f,avx512bw")));
+    template <class T>
+    static size_t count(const T * data, size_t n, T value) __attribute__((target("avx512f,avx512bw,popcnt")));
+    template <class T>
+    static size_t mismatch(const T * first, const T * second, size_t n) __attribute__((target("avx512f,avx512bw")));
+    template <class T>
+    static void replace(T * data, size_t n, T oldValue, T newValue) __attribute__((target("avx512f,avx512bw")));
+};
+
+template <class T>
+__attribute__((target("avx512f,avx512bw"))) __m512i alg::_Avx512::broadcast(T value)
+{
+    T lanes[64 / sizeof(T)];
+    std::fill(lanes, lanes + 64 / sizeof(T), value);
+    return _mm512_loadu_si512(lanes);
+}
+
+template <class T>
+__attribute__((target("avx512f,avx512bw"))) uint64_t alg::_Avx512::equal(__m512i a, __m512i b)
+{
+    if constexpr (std::is_same<T, float>::value)
+        return _mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), _CMP_EQ_OQ);
+    else if constexpr (std::is_same<T, double>::value)
+        return _mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), _CMP_EQ_OQ);
+    else if constexpr (sizeof(T) == 1)
+        return _mm512_cmpeq_epi8_mask(a, b);
+    else if constexpr (sizeof(T) == 2)
+        return _mm512_cmpeq_epi16_mask(a, b);
+    else if constexpr (sizeof(T) == 4)
+        return _mm512_cmpeq_epi32_mask(a, b);
+    else
+        return _mm512_cmpeq_epi64_mask(a, b);
+}
+
+template <class T>
+__attribute__((target("avx512f,avx512bw"))) size_t alg::_Avx512::find(const T * data, size_t n, T value)
+{
+    constexpr size_t lanes = 64 / sizeof(T);
+    __m512i item = alg::_Avx512::broadcast(value);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        uint64_t mask = alg::_Avx512::equal<T>(_mm512_loadu_si512(data + i), item);
+        if (mask != 0)
+            return i + __builtin_ctzll(mask);
+    }
+    return i + alg::_scalarFind(data + i, n - i, value);
+}
+
+template <class T>
+__attribute__((target("avx512f,avx512bw,popcnt"))) size_t alg::_Avx512::count(const T * data, size_t n, T value)
+{
+    constexpr size_t lanes = 64 / sizeof(T);
+    __m512i item = alg::_Avx512::broadcast(value);
+    size_t res = 0;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+        res += __builtin_popcountll(alg::_Avx512::equal<T>(_mm512_loadu_si512(data + i), item));
+    return res + alg::_scalarCount(data + i, n - i, value);
+}
+
+template <class T>
+__attribute__((target("avx512f,avx512bw"))) size_t alg::_Avx512::mismatch(const T * first, const T * second, size_t n)
+{
+    constexpr size_t lanes = 64 / sizeof(T);
+    constexpr uint64_t all = lanes == 64 ? ~uint64_t(0) : (uint64_t(1) << lanes) - 1;
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        uint64_t mask = alg::_Avx512::equal<T>(_mm512_loadu_si512(first + i), _mm512_loadu_si512(second + i));
+        if (mask != all)
+            return i + __builtin_ctzll(~mask);
+    }
+    return i + alg::_scalarMismatch(first + i, second + i, n - i);
+}
+
+template <class T>
+__attribute__((target("avx512f,avx512bw"))) void alg::_Avx512::replace(T * data, size_t n, T oldValue, T newValue)
+{
+    constexpr size_t lanes = 64 / sizeof(T);
+    __m512i from = alg::_Avx512::broadcast(oldValue);
+    __m512i to = alg::_Avx512::broadcast(newValue);
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes)
+    {
+        uint64_t mask = alg::_Avx512::equal<T>(_mm512_loadu_si512(data + i), from);
+        if (mask == 0)
+            continue;
+        if constexpr (sizeof(T) == 1)
+            _mm512_mask_storeu_epi8(data + i, mask, to);
+        else if constexpr (sizeof(T) == 2)
+            _mm512_mask_storeu_epi16(data + i, static_cast<__mmask32>(mask), to);
+        else if constexpr (sizeof(T) == 4)
+            _mm512_mask_storeu_epi32(data + i, static_cast<__mmask16>(mask), to);
+        else
+            _mm512_mask_storeu_epi64(data + i, static_cast<__mmask8>(mask), to);
+    }
+    alg::_scalarReplace(data + i, n - i, oldValue, newValue);
+}
+
+#endif
+
+// Index of the first element equal to value, n if there is none.
+template <class T>
+size_t _simdFind(const T * data, size_t n, T value)
+{
+#if defined(ALG_SIMD_X86)
+    switch (alg::_simdLevel())
+    {
+    case 1:
+        return alg::_Sse2::find(data, n, value);
+    case 2:
+        return alg::_Avx2::find(data, n, value);
+    case 3:
+        return alg::_Avx512::find(data, n, value);
+    default:
+        break;
+    }
+#endif
+    return alg::_scalarFind(data, n, value);
+}
+
+template <class T>
+size_t _simdCount(const T * data, size_t n, T value)
+{
+#if defined(ALG_SIMD_X86)
+    switch (alg::_simdLevel())
+    {
+    case 1:
+        return alg::_Sse2::count(data, n, value);
+    case 2:
+        return alg::_Avx2::count(data, n, value);
+    case 3:
+        return alg::_Avx512::count(data, n, value);
+    default:
+        break;
+    }
+#endif
+    return alg::_scalarCount(data, n, value);
+}
+
+// Index of the first position where the ranges differ, n if they do not.
+template <class T>
+size_t _simdMismatch(const T * first, const T * second, size_t n)
+{
+#if defined(ALG_SIMD_X86)
+    switch (alg::_simdLevel())
+    {
+    case 1:
+        return alg::_Sse2::mismatch(first, second, n);
+    case 2:
+        return alg::_Avx2::mismatch(first, second, n);
+    case 3:
+        return alg::_Avx512::mismatch(first, second, n);
+    default:
+        break;
+    }
+#endif
+    return alg::_scalarMismatch(first, second, n);
+}
+
+template <class T>
+void _simdReplace(T * data, size_t n, T oldValue, T newValue)
+{
+#if defined(ALG_SIMD_X86)
+    switch (alg::_simdLevel())
+    {
+    case 1:
+        alg::_Sse2::replace(data, n, oldValue, newValue);
+        return;
+    case 2:
+        alg::_Avx2::replace(data, n, oldValue, newValue);
+        return;
+    case 3:
+        alg::_Avx512::replace(data, n, oldValue, newValue);
+        return;
+    default:
+        break;
+    }
+#endif
+    alg::_scalarReplace(data, n, oldValue, newValue);
+}
+
+}
+
+#endif // ALGSIMD_HPP
@@ -0,0 +1,194 @@
+#ifndef ALGSTATS_HPP
+#define ALGSTATS_HPP
+#include <cstddef>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Instrumentation is compiled in only when ALG_INSTRUMENTATION is defined; otherwise the hook is never
+// called and the snapshot stays empty.
+namespace alg
+{
+
+#if defined(ALG_INSTRUMENTATION)
+constexpr bool instrumentation_enabled = true;
+#else
+constexpr bool instrumentation_enabled = false;
+#endif
+
+struct worker_stats
+{
+    size_t busy_ns;
+    // Counted for random access ranges only.
+    size_t elements;
+    size_t tasks;
+};
+
+struct call_stats
+{
+    const char * algorithm;
+    size_t wall_ns;
+    // Summed over the dispatches of the call: time until the last participant started its first task.
+    size_t dispatch_ns;
+    size_t elements;
+    // Indexed by worker, 0 is the calling thread.
+    std::vector<alg::worker_stats> workers;
+    // Largest busy time over the mean busy time of the workers that took part.
+    double imbalance;
+};
+
+struct algorithm_stats
+{
+    size_t calls;
+    size_t elements;
+    size_t wall_ns;
+    size_t dispatch_ns;
+    size_t busy_ns;
+    double max_imbalance;
+    double mean_imbalance;
+};
+
+using call_hook = std::function<void(const alg::call_stats &)>;
+
+// Worker index of the current thread in its executor, 0 for threads that are not workers.
+inline thread_local size_t _worker_index = 0;
+
+inline std::mutex _stats_mutex;
+inline alg::call_hook _call_hook;
+inline std::map<std::string, alg::algorithm_stats> _stats;
+
+// Called after every instrumented call, on the thread that made it; it must not throw.
+inline void set_call_hook(alg::call_hook hook)
+{
+    std::lock_guard<std::mutex> lock(alg::_stats_mutex);
+    alg::_call_hook = std::move(hook);
+}
+
+// Totals per algorithm since the start or the last reset_stats().
+inline std::map<std::string, alg::algorithm_stats> stats_snapshot()
+{
+    std::lock_guard<std::mutex> lock(alg::_stats_mutex);
+    std::map<std::string, alg::algorithm_stats> res = alg::_stats;
+    for (auto & item : res)
+        item.second.mean_imbalance /= static_cast<double>(item.second.calls);
+    return res;
+}
+
+inline void reset_stats()
+{
+    std::lock_guard<std::mutex> lock(alg::_stats_mutex);
+    alg::_stats.clear();
+}
+
+inline size_t _elapsedNs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+#if defined(ALG_INSTRUMENTATION)
+
+struct _CallRecord
+{
+    const char * algorithm;
+    std::chrono::steady_clock::time_point start;
+    std::mutex mutex;
+    std::vector<alg::worker_stats> workers;
+    size_t dispatchNs = 0;
+
+    alg::worker_stats & worker()
+    {
+        if (workers.size() <= alg::_worker_index)
+            workers.resize(alg::_worker_index + 1, alg::worker_stats{0, 0, 0});
+        return workers[alg::_worker_index];
+    }
+};
+
+// The call the current thread works for, also set on workers while they run its tasks.
+inline thread_local alg::_CallRecord * _current_call = nullptr;
+inline thread_local bool _in_timed_task = false;
+
+inline void _publish(alg::_CallRecord & record)
+{
+    alg::call_stats stats{record.algorithm, alg::_elapsedNs(record.start), record.dispatchNs, 0, std::move(record.workers), 1};
+    size_t busy = 0;
+    size_t maxBusy = 0;
+    size_t participants = 0;
+    for (const alg::worker_stats & worker : stats.workers)
+    {
+        stats.elements += worker.elements;
+        busy += worker.busy_ns;
+        maxBusy = std::max(maxBusy, worker.busy_ns);
+        participants += worker.tasks != 0 ? 1 : 0;
+    }
+    if (busy != 0)
+        stats.imbalance = static_cast<double>(maxBusy) * participants / busy;
+    alg::call_hook hook;
+    {
+        std::lock_guard<std::mutex> lock(alg::_stats_mutex);
+        alg::algorithm_stats & total = alg::_stats[stats.algorithm];
+        ++total.calls;
+        total.elements += stats.elements;
+        total.wall_ns += stats.wall_ns;
+        total.dispatch_ns += stats.dispatch_ns;
+        total.busy_ns += busy;
+        total.max_imbalance = std::max(total.max_imbalance, stats.imbalance);
+        total.mean_imbalance += stats.imbalance;
+        hook = alg::_call_hook;
+    }
+    if (hook)
+        hook(stats);
+}
+
+// Opened by every public algorithm; only the outermost one on a thread records the call.
+class _CallScope
+{
+private:
+    alg::_CallRecord record;
+    bool owner;
+public:
+    explicit _CallScope(const char * algorithm) : owner(alg::_current_call == nullptr)
+    {
+        if (!owner)
+            return;
+        record.algorithm = algorithm;
+        record.start = std::chrono::steady_clock::now();
+        alg::_current_call = &record;
+    }
+    ~_CallScope()
+    {
+        if (!owner)
+            return;
+        alg::_current_call = nullptr;
+        alg::_publish(record);
+    }
+    _CallScope(const _CallScope &) = delete;
+    _CallScope & operator=(const _CallScope &) = delete;
+};
+
+inline void _countElements(size_t n)
+{
+    if (alg::_current_call == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(alg::_current_call->mutex);
+    alg::_current_call->worker().elements += n;
+}
+
+#else
+
+class _CallScope
+{
+public:
+    explicit _CallScope(const char *) {}
+};
+
+inline void _countElements(size_t) {}
+
+#endif
+
+}
+
+#endif // ALGSTATS_HPP
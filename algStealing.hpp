@@ -0,0 +1,202 @@
+#ifndef ALGSTEALING_HPP
+#define ALGSTEALING_HPP
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include "algThreads.hpp"
+#include "algCutoff.hpp"
+
+namespace alg
+{
+
+inline std::atomic<size_t> _grain_size(0);
+
+// 0 lets the library pick the grain from the range size.
+inline void set_grain_size(size_t grain)
+{
+    alg::_grain_size = grain;
+}
+
+inline size_t grain_size()
+{
+    return alg::_grain_size;
+}
+
+inline size_t _grainFor(size_t n, size_t parts)
+{
+    size_t grain = alg::_grain_size;
+    if (grain != 0)
+        return grain;
+    grain = n / (parts * 8);
+    return grain == 0 ? 1 : grain;
+}
+
+struct _Range
+{
+    size_t begin;
+    size_t end;
+};
+
+// Owner pushes and pops at the back, thieves take the oldest (largest) ranges from the front.
+class alignas(alg::_cache_line_size) _StealingDeque
+{
+private:
+    static constexpr size_t capacity = 128;
+    std::mutex mutex;
+    alg::_Range ranges[capacity];
+    size_t head;
+    size_t tail;
+public:
+    _StealingDeque() : head(0), tail(0) {}
+
+    bool push(const alg::_Range & range);
+    bool pop(alg::_Range & range);
+    bool steal(alg::_Range & range);
+};
+
+inline bool alg::_StealingDeque::push(const alg::_Range & range)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tail == capacity)
+    {
+        if (head == 0)
+            return false;
+        std::copy(ranges + head, ranges + tail, ranges);
+        tail -= head;
+        head = 0;
+    }
+    ranges[tail++] = range;
+    return true;
+}
+
+inline bool alg::_StealingDeque::pop(alg::_Range & range)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (head == tail)
+        return false;
+    range = ranges[--tail];
+    if (head == tail)
+        head = tail = 0;
+    return true;
+}
+
+inline bool alg::_StealingDeque::steal(alg::_Range & range)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (head == tail)
+        return false;
+    range = ranges[head++];
+    if (head == tail)
+        head = tail = 0;
+    return true;
+}
+
+template <class Body>
+void _inThreadStealing(size_t part, size_t parts, size_t grain, alg::_StealingDeque * deques,
+                       std::atomic<size_t> & remaining, std::atomic<bool> & failed, const Body & body)
+{
+    alg::_Range range;
+    while ((remaining.load() != 0) && !failed.load())
+    {
+        bool found = deques[part].pop(range);
+        for (size_t i = 1; (i < parts) && !found; ++i)
+            found = deques[(part + i) % parts].steal(range);
+        if (!found)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        while (range.end - range.begin > grain)
+        {
+            size_t middle = range.begin + (range.end - range.begin) / 2;
+            if (!deques[part].push(alg::_Range{middle, range.end}))
+                break;
+            range.end = middle;
+        }
+        try
+        {
+            alg::_throwIfCancelled();
+            body(part, range.begin, range.end);
+            alg::_countElements(range.end - range.begin);
+        }
+        catch (...)
+        {
+            failed = true;
+            throw;
+        }
+        remaining -= range.end - range.begin;
+    }
+}
+
+// Runs a prefix of growing size inline until it took min_part_ns. Small ranges finish there without
+// waking anyone; for the others it gives the cost of an element, and so the number of parts worth using.
+// Returns the end of the prefix and sets parts, 1 meaning that the rest is not worth splitting.
+template <class Body>
+size_t _probePrefix(size_t n, size_t & parts, const Body & body)
+{
+    size_t minPartNs = alg::cutoffs().min_part_ns;
+    auto start = std::chrono::steady_clock::now();
+    size_t done = 0;
+    size_t elapsed = 0;
+    // Steps grow eightfold, reading the clock costs about as much as a cheap element loop of a few dozen.
+    for (size_t step = 1; (done < n) && (elapsed < minPartNs); step *= 8)
+    {
+        size_t end = std::min(n, done + step);
+        body(0, done, end);
+        alg::_countElements(end - done);
+        done = end;
+        elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    size_t restNs = static_cast<size_t>(static_cast<double>(n - done) * elapsed / done);
+    parts = std::max<size_t>(1, std::min(parts, restNs / minPartNs));
+    return done;
+}
+
+// Calls body(part, begin, end) over disjoint subranges covering [0, n). After the inline prefix every
+// part starts with what the prefix left of its even share of [0, n), splits it down to the grain size on
+// demand and steals from the others once it runs dry. Shares do not depend on the prefix and go to the
+// same participants on every call, so repeated passes over a buffer find it in the same caches and nodes.
+template <class Body>
+void _stealingFor(alg::executor & ex, size_t n, const Body & body)
+{
+    size_t parts = ex.concurrency();
+    if (n == 0)
+        return;
+    // The inline parts go through run() as well, so that they are timed like any other task.
+    size_t done = 0;
+    ex.run(1, [&](size_t)
+    {
+        if (parts > 1)
+            done = alg::_probePrefix(n, parts, body);
+        if (parts == 1 && done != n)
+        {
+            body(0, done, n);
+            alg::_countElements(n - done);
+            done = n;
+        }
+    });
+    if (done == n)
+        return;
+    size_t grain = alg::_grainFor(n - done, parts);
+    alg::_Scratch<alg::_StealingDeque> deques(parts);
+    for (size_t i = 0; i < parts; ++i)
+    {
+        size_t begin = std::max(done, n / parts * i + std::min(i, n % parts));
+        size_t end = std::max(done, n / parts * (i + 1) + std::min(i + 1, n % parts));
+        if (begin != end)
+            deques[i].push(alg::_Range{begin, end});
+    }
+    std::atomic<size_t> remaining(n - done);
+    std::atomic<bool> failed(false);
+    ex.run_owned(parts, [&](size_t i)
+    {
+        alg::_inThreadStealing(i, parts, grain, deques.get(), remaining, failed, body);
+    });
+}
+
+}
+
+#endif // ALGSTEALING_HPP
@@ -0,0 +1,389 @@
+#ifndef ALGSTREAM_HPP
+#define ALGSTREAM_HPP
+#include <cstddef>
+#include <atomic>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "algThreads.hpp"
+#include "algStats.hpp"
+
+// Streaming mode for sources that can be read only once: input iterators and generators, called as gen()
+// and returning a std::optional that is empty at the end. Items are read in batches into a ring of
+// 2 * concurrency() batches, so at most that many batches are in memory, and the functor runs on the
+// batches while the next ones are read.
+namespace alg
+{
+
+inline std::atomic<size_t> _stream_batch_size(1024);
+
+inline void set_stream_batch_size(size_t items)
+{
+    alg::_stream_batch_size = items == 0 ? 1 : items;
+}
+
+inline size_t stream_batch_size()
+{
+    return alg::_stream_batch_size;
+}
+
+template <class It>
+struct _isInputOnly
+{
+    constexpr static bool value = std::is_same<typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>::value;
+};
+
+template <class It>
+struct _isOutputOnly
+{
+    constexpr static bool value = std::is_same<typename std::iterator_traits<It>::iterator_category, std::output_iterator_tag>::value;
+};
+
+// Batch i goes to cell i % slots. A cell's sequence is i while it is free for batch i, i + 1 once batch i
+// is in it; done is i + 1 once the batch is processed, for the ordered output. Nobody waits on a lock:
+// whoever finds no batch ready and the producer lock free reads the next batches itself, until the ring
+// is full, and whoever finishes a batch writes the ordered output if no one else is doing it.
+template <class T, class Source>
+class _StreamRing
+{
+public:
+    struct alignas(alg::_cache_line_size) _Cell
+    {
+        std::atomic<size_t> sequence;
+        std::atomic<size_t> done;
+        std::vector<T> items;
+    };
+private:
+    Source & source;
+    size_t batchSize;
+    size_t slots;
+    std::unique_ptr<_Cell[]> cells;
+    std::mutex producer;
+    size_t writePos;
+    std::atomic<size_t> readPos;
+    std::atomic<size_t> total;
+    std::mutex writer;
+    std::atomic<size_t> nextWrite;
+    std::atomic<bool> failed;
+
+    bool produce();
+public:
+    _StreamRing(Source & source, size_t batchSize, size_t slots);
+
+    size_t cellCount() const { return slots; }
+    _Cell * acquire(size_t & pos);
+    void release(size_t pos);
+    template <class Write>
+    void complete(size_t pos, const Write & write);
+    void fail() { failed = true; }
+};
+
+template <class T, class Source>
+alg::_StreamRing<T, Source>::_StreamRing(Source & source, size_t batchSize, size_t slots)
+    : source(source), batchSize(batchSize), slots(slots), cells(new _Cell[slots]), writePos(0), readPos(0),
+      total(std::numeric_limits<size_t>::max()), nextWrite(0), failed(false)
+{
+    for (size_t i = 0; i < slots; ++i)
+    {
+        cells[i].sequence = i;
+        cells[i].done = 0;
+        cells[i].items.reserve(batchSize);
+    }
+}
+
+// Returns whether anything was read.
+template <class T, class Source>
+bool alg::_StreamRing<T, Source>::produce()
+{
+    std::unique_lock<std::mutex> lock(producer, std::try_to_lock);
+    if (!lock)
+        return false;
+    bool res = false;
+    while (!failed && (total.load() == std::numeric_limits<size_t>::max()))
+    {
+        _Cell & cell = cells[writePos % slots];
+        if (cell.sequence.load(std::memory_order_acquire) != writePos)
+            break;
+        cell.items.clear();
+        bool more = source(cell.items, batchSize);
+        if (!cell.items.empty())
+        {
+            cell.sequence.store(writePos + 1, std::memory_order_release);
+            ++writePos;
+            res = true;
+        }
+        if (!more)
+        {
+            total = writePos;
+            res = true;
+        }
+    }
+    return res;
+}
+
+// Claims the next batch; nullptr once there are no more or the stream failed.
+template <class T, class Source>
+typename alg::_StreamRing<T, Source>::_Cell * alg::_StreamRing<T, Source>::acquire(size_t & pos)
+{
+    pos = readPos.fetch_add(1);
+    _Cell & cell = cells[pos % slots];
+    while (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+    {
+        if (failed || (pos >= total.load()))
+            return nullptr;
+        if (!produce())
+            std::this_thread::yield();
+    }
+    return &cell;
+}
+
+template <class T, class Source>
+void alg::_StreamRing<T, Source>::release(size_t pos)
+{
+    cells[pos % slots].sequence.store(pos + slots, std::memory_order_release);
+}
+
+// Marks batch pos as processed, then calls write(i) and releases batch i for every processed batch that
+// is next in order. A finisher that finds the writer busy leaves its batch to it; the writer looks again
+// after letting go, so no batch is left behind.
+template <class T, class Source>
+template <class Write>
+void alg::_StreamRing<T, Source>::complete(size_t pos, const Write & write)
+{
+    cells[pos % slots].done.store(pos + 1);
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(writer, std::try_to_lock);
+            if (!lock)
+                return;
+            size_t i = nextWrite.load();
+            for (; cells[i % slots].done.load() == i + 1; ++i)
+            {
+                write(i);
+                release(i);
+                nextWrite = i + 1;
+            }
+        }
+        size_t i = nextWrite.load();
+        if (cells[i % slots].done.load() != i + 1)
+            return;
+    }
+}
+
+template <class It>
+struct _IteratorSource
+{
+    It & first;
+    const It & last;
+
+    template <class T>
+    bool operator()(std::vector<T> & batch, size_t n)
+    {
+        for (; (batch.size() < n) && (first != last); ++first)
+            batch.push_back(*first);
+        return first != last;
+    }
+};
+
+template <class Gen>
+struct _GeneratorSource
+{
+    Gen & gen;
+
+    template <class T>
+    bool operator()(std::vector<T> & batch, size_t n)
+    {
+        while (batch.size() < n)
+        {
+            auto item = gen();
+            if (!item)
+                return false;
+            batch.push_back(std::move(*item));
+        }
+        return true;
+    }
+};
+
+template <class Gen>
+using _generatedType = typename std::decay<decltype(*std::declval<Gen &>()())>::type;
+
+// Calls body(part, pos, items) for every batch; with ordered, write(pos, cells) follows for the batches in
+// the order they were read. part is below ex.concurrency().
+template <bool ordered, class T, class Source, class Body, class Write>
+void _stream(alg::executor & ex, Source & source, const Body & body, const Write & write)
+{
+    alg::_StreamRing<T, Source> ring(source, alg::_stream_batch_size, 2 * ex.concurrency());
+    ex.run(ex.concurrency(), [&](size_t part)
+    {
+        try
+        {
+            size_t pos;
+            while (typename alg::_StreamRing<T, Source>::_Cell * cell = ring.acquire(pos))
+            {
+                alg::_throwIfCancelled();
+                body(part, pos, cell->items);
+                alg::_countElements(cell->items.size());
+                if constexpr (ordered)
+                    ring.complete(pos, [&](size_t i) { write(i, ring.cellCount()); });
+                else
+                    ring.release(pos);
+            }
+        }
+        catch (...)
+        {
+            ring.fail();
+            throw;
+        }
+    });
+}
+
+template <class T, class Source, class Func>
+void _streamForEach(alg::executor & ex, Source & source, const Func & f)
+{
+    alg::_stream<false, T>(ex, source, [&f](size_t, size_t, std::vector<T> & items)
+    {
+        for (T & item : items)
+            f(item);
+    }, nullptr);
+}
+
+template <class Diff, class T, class Source, class Func>
+Diff _streamCountIf(alg::executor & ex, Source & source, const Func & f)
+{
+    std::atomic<Diff> res(0);
+    alg::_stream<false, T>(ex, source, [&](size_t, size_t, std::vector<T> & items)
+    {
+        Diff count = 0;
+        for (const T & item : items)
+            if (f(item))
+                ++count;
+        res.fetch_add(count, std::memory_order_relaxed);
+    }, nullptr);
+    return res;
+}
+
+// Results of batch i wait in results[i % cells] until the batches before them are written. f is called as
+// f(part, item), part being below ex.concurrency().
+template <class T, class Source, class OutputIt, class Func>
+OutputIt _streamTransformParts(alg::executor & ex, Source & source, OutputIt d_first, const Func & f)
+{
+    using R = typename std::decay<std::invoke_result_t<const Func &, size_t, T &>>::type;
+    std::unique_ptr<std::vector<R>[]> results(new std::vector<R>[2 * ex.concurrency()]);
+    alg::_stream<true, T>(ex, source, [&](size_t part, size_t pos, std::vector<T> & items)
+    {
+        std::vector<R> & out = results[pos % (2 * ex.concurrency())];
+        out.clear();
+        for (T & item : items)
+            out.push_back(f(part, item));
+    }, [&](size_t pos, size_t cells)
+    {
+        for (R & item : results[pos % cells])
+        {
+            *d_first = std::move(item);
+            ++d_first;
+        }
+    });
+    return d_first;
+}
+
+template <class T, class Source, class OutputIt, class Func>
+OutputIt _streamTransform(alg::executor & ex, Source & source, OutputIt d_first, const Func & f)
+{
+    return alg::_streamTransformParts<T>(ex, source, d_first, [&f](size_t, T & item) { return f(item); });
+}
+
+template <class It, class Func>
+void stream_for_each(alg::executor & ex, It first, const It & last, const Func & f)
+{
+    alg::_CallScope scope("stream_for_each");
+    alg::_IteratorSource<It> source{first, last};
+    alg::_streamForEach<typename std::iterator_traits<It>::value_type>(ex, source, f);
+}
+
+template <class It, class Func>
+void stream_for_each(It first, const It & last, const Func & f)
+{
+    alg::stream_for_each(alg::default_executor(), first, last, f);
+}
+
+template <class Gen, class Func>
+void stream_for_each(alg::executor & ex, Gen gen, const Func & f)
+{
+    alg::_CallScope scope("stream_for_each");
+    alg::_GeneratorSource<Gen> source{gen};
+    alg::_streamForEach<alg::_generatedType<Gen>>(ex, source, f);
+}
+
+template <class Gen, class Func>
+void stream_for_each(Gen gen, const Func & f)
+{
+    alg::stream_for_each(alg::default_executor(), std::move(gen), f);
+}
+
+template <class It, class Func>
+typename std::iterator_traits<It>::difference_type stream_count_if(alg::executor & ex, It first, const It & last, const Func & f)
+{
+    alg::_CallScope scope("stream_count_if");
+    alg::_IteratorSource<It> source{first, last};
+    return alg::_streamCountIf<typename std::iterator_traits<It>::difference_type, typename std::iterator_traits<It>::value_type>(ex, source, f);
+}
+
+template <class It, class Func>
+typename std::iterator_traits<It>::difference_type stream_count_if(It first, const It & last, const Func & f)
+{
+    return alg::stream_count_if(alg::default_executor(), first, last, f);
+}
+
+template <class Gen, class Func>
+std::ptrdiff_t stream_count_if(alg::executor & ex, Gen gen, const Func & f)
+{
+    alg::_CallScope scope("stream_count_if");
+    alg::_GeneratorSource<Gen> source{gen};
+    return alg::_streamCountIf<std::ptrdiff_t, alg::_generatedType<Gen>>(ex, source, f);
+}
+
+template <class Gen, class Func>
+std::ptrdiff_t stream_count_if(Gen gen, const Func & f)
+{
+    return alg::stream_count_if(alg::default_executor(), std::move(gen), f);
+}
+
+// The output is written in input order, by one thread at a time, so any output iterator works.
+template <class InputIt, class OutputIt, class Func>
+OutputIt stream_transform(alg::executor & ex, InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("stream_transform");
+    alg::_IteratorSource<InputIt> source{first, last};
+    return alg::_streamTransform<typename std::iterator_traits<InputIt>::value_type>(ex, source, d_first, f);
+}
+
+template <class InputIt, class OutputIt, class Func>
+OutputIt stream_transform(InputIt first, const InputIt & last, OutputIt d_first, const Func & f)
+{
+    return alg::stream_transform(alg::default_executor(), first, last, d_first, f);
+}
+
+template <class Gen, class OutputIt, class Func>
+OutputIt stream_transform(alg::executor & ex, Gen gen, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("stream_transform");
+    alg::_GeneratorSource<Gen> source{gen};
+    return alg::_streamTransform<alg::_generatedType<Gen>>(ex, source, d_first, f);
+}
+
+template <class Gen, class OutputIt, class Func>
+OutputIt stream_transform(Gen gen, OutputIt d_first, const Func & f)
+{
+    return alg::stream_transform(alg::default_executor(), std::move(gen), d_first, f);
+}
+
+}
+
+#endif // ALGSTREAM_HPP
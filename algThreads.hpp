@@ -2,20 +2,380 @@
 #define ALGTHREADS_HPP
 #include <thread>
 #include <cstdint>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <chrono>
+#include <memory>
+#include <deque>
+#include <functional>
+#include "algStats.hpp"
+#include "algScratch.hpp"
+#include "algNuma.hpp"
 
 namespace alg
 {
 
-static uint8_t _num_of_threads = static_cast<uint8_t>((std::thread::hardware_concurrency()) == 0 ? 1 : std::thread::hardware_concurrency());
+constexpr size_t _cache_line_size = 64;
 
-static std::thread * _threads = new std::thread[_num_of_threads];
+inline size_t _num_of_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
 
-void _joinAllThreads()
+// The executor whose worker the current thread is, if any.
+inline thread_local const void * _worker_executor = nullptr;
+
+// Thrown out of the algorithms of a cancelled alg::async handle.
+class operation_cancelled : public std::exception
+{
+public:
+    const char * what() const noexcept override { return "alg: operation cancelled"; }
+};
+
+// Cancel flag of the asynchronous call the current thread works for; run() hands it on to the workers.
+inline thread_local const std::atomic<bool> * _current_cancel = nullptr;
+
+// Checked before every task and between the ranges of a stealing loop.
+inline void _throwIfCancelled()
+{
+    if ((alg::_current_cancel != nullptr) && alg::_current_cancel->load(std::memory_order_relaxed))
+        throw alg::operation_cancelled();
+}
+
+// Owns concurrency() - 1 workers; the thread calling run() is the last participant.
+// Any number of threads may call run() at the same time, and tasks may call run() again:
+// every caller works on its own job while idle workers help with whichever job has tasks left.
+// Workers can be pinned to CPUs; participant 0 is whichever thread calls run() and is left alone.
+class executor
+{
+private:
+    // Tasks run_owned() gives to one participant first.
+    struct alignas(alg::_cache_line_size) _Share
+    {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+
+    struct _Job
+    {
+        void (*call)(const void *, size_t);
+        const void * context;
+        size_t count;
+        std::atomic<size_t> next;
+        size_t users;
+        std::exception_ptr error;
+        _Job * nextJob;
+        _Share * shares;
+        const std::atomic<bool> * cancel;
+#if defined(ALG_INSTRUMENTATION)
+        alg::_CallRecord * record;
+        std::chrono::steady_clock::time_point posted;
+        size_t lastStartNs;
+#endif
+    };
+
+    std::vector<std::thread> workers;
+    size_t numOfThreads;
+    std::vector<size_t> placement;
+    std::mutex mutex;
+    std::condition_variable workCv;
+    std::condition_variable doneCv;
+    _Job * jobs;
+    std::deque<std::function<void()>> posted;
+    bool stopping;
+
+    void start();
+    void workerLoop(size_t index);
+    size_t participant() const;
+    size_t claimShare(_Job & current, size_t self) const;
+    void runTasks(_Job & current);
+    void runTask(_Job & current, size_t i, bool first);
+    _Job * findJob() const;
+    void removeJob(_Job & current);
+
+    template <class Func>
+    static void callTask(const void * context, size_t i) { (*static_cast<const Func *>(context))(i); }
+    template <class Func>
+    void dispatch(size_t count, const Func & f, bool owned);
+public:
+    explicit executor(size_t concurrency = alg::_num_of_threads);
+    executor(size_t concurrency, alg::affinity policy);
+    // Participant i runs on cpus[i].
+    explicit executor(std::vector<size_t> cpus);
+    ~executor();
+    executor(const executor &) = delete;
+    executor & operator=(const executor &) = delete;
+
+    size_t concurrency() const { return numOfThreads; }
+    // CPU of every participant, empty when the workers are not pinned.
+    const std::vector<size_t> & cpus() const { return placement; }
+
+    template <class Func>
+    void run(size_t count, const Func & f);
+    template <class Func>
+    void run_owned(size_t count, const Func & f);
+    void post(std::function<void()> f);
+};
+
+inline alg::executor::executor(size_t concurrency) : numOfThreads(concurrency == 0 ? 1 : concurrency), jobs(nullptr), stopping(false)
+{
+    start();
+}
+
+inline alg::executor::executor(size_t concurrency, alg::affinity policy)
+    : numOfThreads(concurrency == 0 ? 1 : concurrency), placement(alg::_placement(policy, numOfThreads)), jobs(nullptr), stopping(false)
+{
+    start();
+}
+
+inline alg::executor::executor(std::vector<size_t> cpus)
+    : numOfThreads(cpus.empty() ? 1 : cpus.size()), placement(std::move(cpus)), jobs(nullptr), stopping(false)
+{
+    start();
+}
+
+inline void alg::executor::start()
+{
+    workers.reserve(numOfThreads - 1);
+    for (size_t i = 1; i < numOfThreads; ++i)
+        workers.emplace_back(&alg::executor::workerLoop, this, i);
+}
+
+inline alg::executor::~executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workCv.notify_all();
+    for (std::thread & worker : workers)
+        worker.join();
+}
+
+inline alg::executor::_Job * alg::executor::findJob() const
+{
+    for (_Job * current = jobs; current != nullptr; current = current->nextJob)
+        if (current->next.load() < current->count)
+            return current;
+    return nullptr;
+}
+
+inline void alg::executor::removeJob(_Job & current)
+{
+    _Job ** link = &jobs;
+    while (*link != &current)
+        link = &(*link)->nextJob;
+    *link = current.nextJob;
+}
+
+inline size_t alg::executor::participant() const
+{
+    return alg::_worker_executor == this ? alg::_worker_index : 0;
+}
+
+// A task was reserved through next, so some share still has one left; the own share goes first.
+inline size_t alg::executor::claimShare(_Job & current, size_t self) const
+{
+    for (size_t k = 0; ; ++k)
+    {
+        _Share & share = current.shares[(self + k) % numOfThreads];
+        if (share.next.load() >= share.end)
+            continue;
+        size_t i = share.next.fetch_add(1);
+        if (i < share.end)
+            return i;
+    }
+}
+
+#if defined(ALG_INSTRUMENTATION)
+// Tasks run inside another timed task of the same thread are already part of its busy time.
+inline void alg::executor::runTask(_Job & current, size_t i, bool first)
+{
+    if (current.record == nullptr || alg::_in_timed_task)
+    {
+        current.call(current.context, i);
+        return;
+    }
+    alg::_CallRecord * outer = alg::_current_call;
+    alg::_current_call = current.record;
+    alg::_in_timed_task = true;
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+        current.call(current.context, i);
+    }
+    catch (...)
+    {
+        alg::_current_call = outer;
+        alg::_in_timed_task = false;
+        throw;
+    }
+    size_t busyNs = alg::_elapsedNs(start);
+    alg::_current_call = outer;
+    alg::_in_timed_task = false;
+    std::lock_guard<std::mutex> lock(current.record->mutex);
+    alg::worker_stats & worker = current.record->worker();
+    worker.busy_ns += busyNs;
+    ++worker.tasks;
+    if (first)
+        current.lastStartNs = std::max<size_t>(current.lastStartNs, std::chrono::duration_cast<std::chrono::nanoseconds>(start - current.posted).count());
+}
+#else
+inline void alg::executor::runTask(_Job & current, size_t i, bool)
+{
+    current.call(current.context, i);
+}
+#endif
+
+inline void alg::executor::runTasks(_Job & current)
+{
+    bool first = true;
+    size_t self = participant();
+    const std::atomic<bool> * outerCancel = alg::_current_cancel;
+    alg::_current_cancel = current.cancel;
+    for (size_t i = current.next.fetch_add(1); i < current.count; i = current.next.fetch_add(1), first = false)
+    {
+        if (current.shares != nullptr)
+            i = claimShare(current, self);
+        try
+        {
+            alg::_throwIfCancelled();
+            runTask(current, i, first);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!current.error)
+                current.error = std::current_exception();
+        }
+    }
+    alg::_current_cancel = outerCancel;
+}
+
+inline void alg::executor::workerLoop(size_t index)
+{
+    alg::_worker_index = index;
+    alg::_worker_executor = this;
+    if (!placement.empty())
+        alg::pin_this_thread(placement[index]);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        _Job * current = nullptr;
+        workCv.wait(lock, [this, &current] { return stopping || ((current = findJob()) != nullptr) || !posted.empty(); });
+        // Helping running jobs comes first, posted calls start when nothing else is left; they are all
+        // finished before the workers stop.
+        if (current == nullptr)
+        {
+            if (posted.empty())
+                return;
+            std::function<void()> call = std::move(posted.front());
+            posted.pop_front();
+            lock.unlock();
+            call();
+            lock.lock();
+            continue;
+        }
+        ++current->users;
+        lock.unlock();
+        runTasks(*current);
+        lock.lock();
+        if (--current->users == 0)
+            doneCv.notify_all();
+    }
+}
+
+// Calls f(i) for every i in [0, count) on the workers and the calling thread, returns when all calls are done.
+template <class Func>
+void alg::executor::run(size_t count, const Func & f)
+{
+    dispatch(count, f, false);
+}
+
+// As run(), but participant p first takes the p-th even share of [0, count), so repeated calls with the
+// same count hand the same tasks to the same threads, and with pinned workers to the same NUMA nodes.
+// Participants that are idle still take over the shares of busy ones.
+template <class Func>
+void alg::executor::run_owned(size_t count, const Func & f)
+{
+    dispatch(count, f, count > 1 && numOfThreads > 1);
+}
+
+template <class Func>
+void alg::executor::dispatch(size_t count, const Func & f, bool owned)
+{
+    alg::_Scratch<_Share> shares(owned ? numOfThreads : 0);
+    if (owned)
+    {
+        for (size_t p = 0; p < numOfThreads; ++p)
+        {
+            shares[p].next = count / numOfThreads * p + std::min(p, count % numOfThreads);
+            shares[p].end = count / numOfThreads * (p + 1) + std::min(p + 1, count % numOfThreads);
+        }
+    }
+    _Job current;
+    current.call = &alg::executor::callTask<Func>;
+    current.context = &f;
+    current.count = count;
+    current.next = 0;
+    current.users = 0;
+    current.shares = shares.get();
+    current.cancel = alg::_current_cancel;
+#if defined(ALG_INSTRUMENTATION)
+    current.record = alg::_current_call;
+    current.posted = std::chrono::steady_clock::now();
+    current.lastStartNs = 0;
+#endif
+    if (count > 1 && !workers.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current.nextJob = jobs;
+            jobs = &current;
+        }
+        workCv.notify_all();
+        runTasks(current);
+        std::unique_lock<std::mutex> lock(mutex);
+        removeJob(current);
+        doneCv.wait(lock, [&current] { return current.users == 0; });
+    }
+    else
+    {
+        runTasks(current);
+    }
+#if defined(ALG_INSTRUMENTATION)
+    if (current.record != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(current.record->mutex);
+        current.record->dispatchNs += current.lastStartNs;
+    }
+#endif
+    if (current.error)
+        std::rethrow_exception(current.error);
+}
+
+// Runs f on a worker once one is free, or right away on the calling thread when there are no workers.
+// f must not throw.
+inline void alg::executor::post(std::function<void()> f)
+{
+    if (workers.empty())
+    {
+        f();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        posted.push_back(std::move(f));
+    }
+    workCv.notify_one();
+}
+
+inline alg::executor & default_executor()
 {
-    std::thread * beg = _threads;
-    std::thread * end = _threads + _num_of_threads;
-    for (; beg != end; ++beg)
-        beg->join();
+    static alg::executor ex;
+    return ex;
 }
 
 }
@@ -0,0 +1,185 @@
+#ifndef ALGTILES_HPP
+#define ALGTILES_HPP
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include "algStealing.hpp"
+
+// Index spaces of N dimensions, row-major (the last index varies fastest), cut into tiles that are handed
+// out in Morton order: a run of consecutive codes covers a compact block of tiles, so each thread works on
+// neighbouring tiles and kernels such as transposes and stencils find the rows they read still in cache.
+namespace alg
+{
+
+// A tile is meant to fit in L1 together with what its kernel reads.
+constexpr size_t _tile_bytes = 1 << 15;
+
+// Prefetching runs along the contiguous last dimension, so tiles are this many times longer along it than
+// along the others: short rows cost stencils more than square tiles save transposes.
+constexpr size_t _tile_aspect = 16;
+
+// Tiles of about _tile_bytes of elementBytes each; a zero in tile asks for that default, other entries are
+// kept.
+template <size_t N>
+std::array<size_t, N> _tileFor(const std::array<size_t, N> & extents, std::array<size_t, N> tile, size_t elementBytes)
+{
+    size_t budget = std::max<size_t>(1, alg::_tile_bytes / elementBytes);
+    auto volume = [](size_t side)
+    {
+        size_t res = 1;
+        for (size_t d = 0; d < N; ++d)
+            res *= side;
+        return res;
+    };
+    size_t side = 1;
+    while (volume(side * 2) * alg::_tile_aspect <= budget)
+        side *= 2;
+    size_t others = 1;
+    for (size_t d = 0; d + 1 < N; ++d)
+    {
+        if (tile[d] == 0)
+            tile[d] = std::min(side, std::max<size_t>(1, extents[d]));
+        others *= tile[d];
+    }
+    // The last dimension is contiguous, it takes whatever the others leave of the budget.
+    if (tile[N - 1] == 0)
+        tile[N - 1] = std::min(std::max<size_t>(1, budget / others), std::max<size_t>(1, extents[N - 1]));
+    return tile;
+}
+
+// Tile coordinates of a Morton code over a grid of 2^bits[d] tiles per dimension. A dimension stops taking
+// bits once it has all of its own, so a grid of unequal sides leaves at most half the codes of every
+// dimension empty.
+template <size_t N>
+std::array<size_t, N> _mortonDecode(size_t code, const std::array<size_t, N> & bits)
+{
+    std::array<size_t, N> res{};
+    for (size_t level = 0; code != 0; ++level)
+        for (size_t d = N; d-- > 0;)
+            if (level < bits[d])
+            {
+                res[d] |= (code & 1) << level;
+                code >>= 1;
+            }
+    return res;
+}
+
+// Calls tileBody(lo, hi) for every tile [lo, hi) of the index space; codes outside the grid are skipped.
+template <size_t N, class TileBody>
+void _forEachTile(alg::executor & ex, const std::array<size_t, N> & extents, const std::array<size_t, N> & tile, const TileBody & tileBody)
+{
+    std::array<size_t, N> bits;
+    size_t codes = 1;
+    for (size_t d = 0; d < N; ++d)
+    {
+        if (extents[d] == 0)
+            return;
+        size_t tiles = (extents[d] + tile[d] - 1) / tile[d];
+        for (bits[d] = 0; (size_t(1) << bits[d]) < tiles; ++bits[d]);
+        codes <<= bits[d];
+    }
+    alg::_stealingFor(ex, codes, [&](size_t, size_t begin, size_t end)
+    {
+        for (size_t code = begin; code < end; ++code)
+        {
+            std::array<size_t, N> at = alg::_mortonDecode(code, bits);
+            std::array<size_t, N> lo;
+            std::array<size_t, N> hi;
+            bool inside = true;
+            for (size_t d = 0; inside && (d < N); ++d)
+            {
+                lo[d] = at[d] * tile[d];
+                hi[d] = std::min(extents[d], lo[d] + tile[d]);
+                inside = lo[d] < extents[d];
+            }
+            if (inside)
+                tileBody(lo, hi);
+        }
+    });
+}
+
+template <size_t D, size_t N, class Func>
+void _forEachInTile(std::array<size_t, N> & index, const std::array<size_t, N> & lo, const std::array<size_t, N> & hi, const Func & f)
+{
+    for (index[D] = lo[D]; index[D] < hi[D]; ++index[D])
+    {
+        if constexpr (D + 1 == N)
+            f(static_cast<const std::array<size_t, N> &>(index));
+        else
+            alg::_forEachInTile<D + 1>(index, lo, hi, f);
+    }
+}
+
+// Calls f(index) for every index of the space, with index a const std::array<size_t, N> &.
+template <size_t N, class Func>
+void for_each_index(alg::executor & ex, const std::array<size_t, N> & extents, const std::array<size_t, N> & tile, const Func & f)
+{
+    static_assert(N > 0, "alg: an index space needs at least one dimension");
+    alg::_CallScope scope("for_each_index");
+    alg::_forEachTile(ex, extents, alg::_tileFor(extents, tile, sizeof(size_t)), [&f](const std::array<size_t, N> & lo, const std::array<size_t, N> & hi)
+    {
+        std::array<size_t, N> index;
+        alg::_forEachInTile<0>(index, lo, hi, f);
+    });
+}
+
+template <size_t N, class Func>
+void for_each_index(const std::array<size_t, N> & extents, const std::array<size_t, N> & tile, const Func & f)
+{
+    alg::for_each_index(alg::default_executor(), extents, tile, f);
+}
+
+template <size_t N, class Func>
+void for_each_index(alg::executor & ex, const std::array<size_t, N> & extents, const Func & f)
+{
+    alg::for_each_index(ex, extents, std::array<size_t, N>{}, f);
+}
+
+template <size_t N, class Func>
+void for_each_index(const std::array<size_t, N> & extents, const Func & f)
+{
+    alg::for_each_index(alg::default_executor(), extents, f);
+}
+
+// Writes f(row, col) to d_first[row * cols + col]; the output has to be random access. The default tiles
+// leave room in L1 for as much input as output.
+template <class OutputIt, class Func>
+OutputIt transform_2d(alg::executor & ex, size_t rows, size_t cols, const std::array<size_t, 2> & tile, OutputIt d_first, const Func & f)
+{
+    alg::_CallScope scope("transform_2d");
+    using T = typename std::iterator_traits<OutputIt>::value_type;
+    std::array<size_t, 2> extents{rows, cols};
+    alg::_forEachTile(ex, extents, alg::_tileFor(extents, tile, 2 * sizeof(T)), [&](const std::array<size_t, 2> & lo, const std::array<size_t, 2> & hi)
+    {
+        for (size_t row = lo[0]; row < hi[0]; ++row)
+        {
+            OutputIt out = d_first + (row * cols + lo[1]);
+            for (size_t col = lo[1]; col < hi[1]; ++col, ++out)
+                *out = f(row, col);
+        }
+    });
+    return d_first + rows * cols;
+}
+
+template <class OutputIt, class Func>
+OutputIt transform_2d(size_t rows, size_t cols, const std::array<size_t, 2> & tile, OutputIt d_first, const Func & f)
+{
+    return alg::transform_2d(alg::default_executor(), rows, cols, tile, d_first, f);
+}
+
+template <class OutputIt, class Func>
+OutputIt transform_2d(alg::executor & ex, size_t rows, size_t cols, OutputIt d_first, const Func & f)
+{
+    return alg::transform_2d(ex, rows, cols, std::array<size_t, 2>{}, d_first, f);
+}
+
+template <class OutputIt, class Func>
+OutputIt transform_2d(size_t rows, size_t cols, OutputIt d_first, const Func & f)
+{
+    return alg::transform_2d(alg::default_executor(), rows, cols, d_first, f);
+}
+
+}
+
+#endif // ALGTILES_HPP
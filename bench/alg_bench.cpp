@@ -0,0 +1,703 @@
+// Runs the algorithms of alg.hpp against serial std and std::execution::par over sizes, element types,
+// containers and thread counts, and writes every measurement to a JSON file.
+// ./alg_bench --help lists the filters.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#if ALG_BENCH_HAVE_PAR
+#include <execution>
+#include <tbb/global_control.h>
+#define ALG_BENCH_PAR(...) [&] { __VA_ARGS__; }
+#else
+#define ALG_BENCH_PAR(...) nullptr
+#define ALG_BENCH_HAVE_PAR 0
+#endif
+#include "../alg.hpp"
+#include "../algPipe.hpp"
+
+#ifndef ALG_BENCH_VERSION
+#define ALG_BENCH_VERSION "unknown"
+#endif
+
+namespace
+{
+
+struct Record
+{
+    uint64_t key;
+    uint64_t payload[7];
+};
+
+bool operator<(const Record & left, const Record & right)
+{
+    return left.key < right.key;
+}
+
+bool operator==(const Record & left, const Record & right)
+{
+    return left.key == right.key && std::equal(left.payload, left.payload + 7, right.payload);
+}
+
+bool operator!=(const Record & left, const Record & right)
+{
+    return !(left == right);
+}
+
+uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+template <class T>
+T makeValue(uint64_t i);
+
+template <>
+int makeValue<int>(uint64_t i)
+{
+    return static_cast<int>(mix(i) % 1000000);
+}
+
+template <>
+double makeValue<double>(uint64_t i)
+{
+    return static_cast<double>(mix(i) % 1000000) * 0.5;
+}
+
+template <>
+Record makeValue<Record>(uint64_t i)
+{
+    Record res{mix(i) % 1000000, {}};
+    std::fill(res.payload, res.payload + 7, i);
+    return res;
+}
+
+// Long enough to live on the heap.
+template <>
+std::string makeValue<std::string>(uint64_t i)
+{
+    return "benchmark-string-" + std::to_string(mix(i) % 1000000);
+}
+
+uint64_t keyOf(int value) { return static_cast<uint64_t>(value); }
+uint64_t keyOf(double value) { return static_cast<uint64_t>(value * 2); }
+uint64_t keyOf(const Record & value) { return value.key; }
+uint64_t keyOf(const std::string & value) { return static_cast<unsigned char>(value.back()); }
+
+int bump(int value) { return value + 1; }
+double bump(double value) { return value * 1.5 + 1; }
+Record bump(const Record & value) { Record res = value; ++res.key; return res; }
+std::string bump(const std::string & value) { std::string res = value; res.back() = static_cast<char>('0' + (res.back() - '0' + 1) % 10); return res; }
+
+template <class T>
+size_t bytesPerElement()
+{
+    return sizeof(T) + (std::is_same<T, std::string>::value ? 32 : 0);
+}
+
+template <class C>
+size_t containerOverhead()
+{
+    return std::is_same<C, std::list<typename C::value_type>>::value ? 2 * sizeof(void *) : 0;
+}
+
+struct Options
+{
+    std::string out = "alg_bench.json";
+    size_t minExponent = 2;
+    size_t maxExponent = 9;
+    size_t maxBytes = size_t(1) << 30;
+    double minSeconds = 0.05;
+    size_t maxRepetitions = 20;
+    std::vector<size_t> threads;
+    std::vector<std::string> types = {"int", "double", "record64", "string"};
+    std::vector<std::string> containers = {"vector", "deque", "list"};
+    std::vector<std::string> algorithms;
+};
+
+std::vector<std::string> splitList(const std::string & value)
+{
+    std::vector<std::string> res;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (!item.empty())
+            res.push_back(item);
+    return res;
+}
+
+bool contains(const std::vector<std::string> & items, const std::string & item)
+{
+    return std::find(items.begin(), items.end(), item) != items.end();
+}
+
+struct Result
+{
+    std::string algorithm;
+    std::string implementation;
+    std::string type;
+    std::string container;
+    size_t n;
+    size_t threads;
+    size_t repetitions;
+    double minNs;
+    double medianNs;
+};
+
+struct Case
+{
+    const char * type;
+    const char * container;
+    size_t n;
+};
+
+class Suite
+{
+private:
+    Options options;
+    std::vector<Result> results;
+    std::map<size_t, std::unique_ptr<alg::executor>> executors;
+
+    alg::executor & executorFor(size_t threads);
+
+    template <class Prepare, class Run>
+    void measure(const Case & where, const char * algorithm, const char * implementation, size_t threads,
+                 const Prepare & prepare, const Run & run);
+public:
+    explicit Suite(const Options & options) : options(options) {}
+
+    const Options & settings() const { return options; }
+
+    template <class Prepare, class StdRun, class ParRun, class AlgRun>
+    void compare(const Case & where, const char * algorithm, const Prepare & prepare,
+                 const StdRun & stdRun, const ParRun & parRun, const AlgRun & algRun);
+
+    bool write() const;
+};
+
+alg::executor & Suite::executorFor(size_t threads)
+{
+    std::unique_ptr<alg::executor> & ex = executors[threads];
+    if (!ex)
+        ex.reset(new alg::executor(threads));
+    return *ex;
+}
+
+template <class Prepare, class Run>
+void Suite::measure(const Case & where, const char * algorithm, const char * implementation, size_t threads,
+                    const Prepare & prepare, const Run & run)
+{
+    std::vector<double> times;
+    double total = 0;
+    while (times.empty() || ((total < options.minSeconds * 1e9) && (times.size() < options.maxRepetitions)))
+    {
+        prepare();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        total += times.back();
+    }
+    std::sort(times.begin(), times.end());
+    results.push_back(Result{algorithm, implementation, where.type, where.container, where.n, threads,
+                             times.size(), times.front(), times[times.size() / 2]});
+    std::printf("%-24s %-8s %-8s %-6s %11zu %3zu threads %14.0f ns\n", algorithm, implementation, where.type,
+                where.container, where.n, threads, times[times.size() / 2]);
+    std::fflush(stdout);
+}
+
+// std runs once per case, std_par and alg once per thread count. A nullptr parRun means that std has no
+// parallel overload for the algorithm or that the build has no std::execution.
+template <class Prepare, class StdRun, class ParRun, class AlgRun>
+void Suite::compare(const Case & where, const char * algorithm, const Prepare & prepare,
+                    const StdRun & stdRun, const ParRun & parRun, const AlgRun & algRun)
+{
+    if (!options.algorithms.empty() && !contains(options.algorithms, algorithm))
+        return;
+    measure(where, algorithm, "std", 1, prepare, stdRun);
+    for (size_t threads : options.threads)
+    {
+        if constexpr (!std::is_same<ParRun, std::nullptr_t>::value)
+        {
+#if ALG_BENCH_HAVE_PAR
+            tbb::global_control limit(tbb::global_control::max_allowed_parallelism, threads);
+#endif
+            measure(where, algorithm, "std_par", threads, prepare, parRun);
+        }
+        alg::executor & ex = executorFor(threads);
+        measure(where, algorithm, "alg", threads, prepare, [&] { algRun(ex); });
+    }
+}
+
+bool Suite::write() const
+{
+    std::FILE * file = std::fopen(options.out.c_str(), "w");
+    if (file == nullptr)
+        return false;
+    alg::cutoff_thresholds cutoffs = alg::cutoffs();
+    std::fprintf(file, "{\n  \"version\": \"%s\",\n  \"hardware_concurrency\": %u,\n  \"par_available\": %s,\n",
+                 ALG_BENCH_VERSION, std::thread::hardware_concurrency(), ALG_BENCH_HAVE_PAR ? "true" : "false");
+    std::fprintf(file, "  \"cutoffs\": {\"min_part_ns\": %zu, \"min_part_elements\": %zu},\n  \"simd_level\": %d,\n  \"results\": [\n",
+                 cutoffs.min_part_ns, cutoffs.min_part_elements, alg::_simdLevel());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result & result = results[i];
+        std::fprintf(file, "    {\"algorithm\": \"%s\", \"implementation\": \"%s\", \"type\": \"%s\", \"container\": \"%s\", "
+                           "\"n\": %zu, \"threads\": %zu, \"repetitions\": %zu, \"min_ns\": %.0f, \"median_ns\": %.0f}%s\n",
+                     result.algorithm.c_str(), result.implementation.c_str(), result.type.c_str(), result.container.c_str(),
+                     result.n, result.threads, result.repetitions, result.minNs, result.medianNs, i + 1 == results.size() ? "" : ",");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    return std::fclose(file) == 0;
+}
+
+template <class C>
+void runCases(Suite & suite, const Case & where)
+{
+    using T = typename C::value_type;
+    using It = typename C::iterator;
+    constexpr bool randomAccess = std::is_same<typename std::iterator_traits<It>::iterator_category, std::random_access_iterator_tag>::value;
+    constexpr bool arithmetic = std::is_arithmetic<T>::value;
+    size_t n = where.n;
+
+    C input;
+    for (size_t i = 0; i < n; ++i)
+        input.push_back(makeValue<T>(i));
+    C work(input);
+    C output(n);
+    C second(n);
+    const T target = makeValue<T>(n * 3 / 4);
+    const T replacement = makeValue<T>(n + 1);
+    auto selected = [](const T & value) { return keyOf(value) % 3 == 0; };
+    auto matches = [&target](const T & value) { return keyOf(value) == keyOf(target) && value == target; };
+    auto op = [](const T & value) { return bump(value); };
+    auto smaller = [](const T & left, const T & right) { return keyOf(left) < keyOf(right) ? left : right; };
+    auto key = [](const T & value) { return keyOf(value); };
+    auto nothing = [] {};
+    auto restore = [&] { std::copy(input.begin(), input.end(), work.begin()); };
+    volatile uint64_t sink = 0;
+
+    suite.compare(where, "find_first_if", nothing,
+                  [&] { sink = std::find_if(input.begin(), input.end(), matches) != input.end(); },
+                  ALG_BENCH_PAR(sink = std::find_if(std::execution::par, input.begin(), input.end(), matches) != input.end()),
+                  [&](alg::executor & ex) { sink = alg::find_first_if(ex, input.begin(), input.end(), matches) != input.end(); });
+    suite.compare(where, "find_any_if", nothing,
+                  [&] { sink = std::find_if(input.begin(), input.end(), matches) != input.end(); },
+                  ALG_BENCH_PAR(sink = std::find_if(std::execution::par, input.begin(), input.end(), matches) != input.end()),
+                  [&](alg::executor & ex) { sink = alg::find_any_if(ex, input.begin(), input.end(), matches) != input.end(); });
+    suite.compare(where, "find", nothing,
+                  [&] { sink = std::find(input.begin(), input.end(), target) != input.end(); },
+                  ALG_BENCH_PAR(sink = std::find(std::execution::par, input.begin(), input.end(), target) != input.end()),
+                  [&](alg::executor & ex) { sink = alg::find(ex, input.begin(), input.end(), target) != input.end(); });
+    suite.compare(where, "find_any", nothing,
+                  [&] { sink = std::find(input.begin(), input.end(), target) != input.end(); },
+                  ALG_BENCH_PAR(sink = std::find(std::execution::par, input.begin(), input.end(), target) != input.end()),
+                  [&](alg::executor & ex) { sink = alg::find_any(ex, input.begin(), input.end(), target) != input.end(); });
+    suite.compare(where, "adjacent_find", nothing,
+                  [&] { sink = std::adjacent_find(input.begin(), input.end()) != input.end(); },
+                  ALG_BENCH_PAR(sink = std::adjacent_find(std::execution::par, input.begin(), input.end()) != input.end()),
+                  [&](alg::executor & ex) { sink = alg::adjacent_find(ex, input.begin(), input.end()) != input.end(); });
+    std::vector<T> pattern(std::next(input.begin(), n * 3 / 4), std::next(input.begin(), std::min(n, n * 3 / 4 + 4)));
+    suite.compare(where, "search", nothing,
+                  [&] { sink = std::search(input.begin(), input.end(), pattern.begin(), pattern.end()) != input.end(); },
+                  ALG_BENCH_PAR(sink = std::search(std::execution::par, input.begin(), input.end(), pattern.begin(), pattern.end()) != input.end()),
+                  [&](alg::executor & ex) { sink = alg::search(ex, input.begin(), input.end(), pattern.begin(), pattern.end()) != input.end(); });
+    if constexpr (randomAccess && arithmetic)
+    {
+        suite.compare(where, "search_horspool", nothing,
+                      [&] { sink = std::search(input.begin(), input.end(), std::boyer_moore_horspool_searcher(pattern.begin(), pattern.end())) != input.end(); },
+                      ALG_BENCH_PAR(sink = std::search(std::execution::par, input.begin(), input.end(), pattern.begin(), pattern.end()) != input.end()),
+                      [&](alg::executor & ex)
+                      {
+                          sink = alg::search(ex, input.begin(), input.end(), alg::boyer_moore_horspool_searcher(pattern.begin(), pattern.end())) != input.end();
+                      });
+    }
+    suite.compare(where, "search_n", nothing,
+                  [&] { sink = std::search_n(input.begin(), input.end(), 2, target) != input.end(); },
+                  ALG_BENCH_PAR(sink = std::search_n(std::execution::par, input.begin(), input.end(), 2, target) != input.end()),
+                  [&](alg::executor & ex) { sink = alg::search_n(ex, input.begin(), input.end(), 2, target) != input.end(); });
+    suite.compare(where, "all_of", nothing,
+                  [&] { sink = std::all_of(input.begin(), input.end(), std::not_fn(matches)); },
+                  ALG_BENCH_PAR(sink = std::all_of(std::execution::par, input.begin(), input.end(), std::not_fn(matches))),
+                  [&](alg::executor & ex) { sink = alg::all_of(ex, input.begin(), input.end(), std::not_fn(matches)); });
+    suite.compare(where, "any_of", nothing,
+                  [&] { sink = std::any_of(input.begin(), input.end(), matches); },
+                  ALG_BENCH_PAR(sink = std::any_of(std::execution::par, input.begin(), input.end(), matches)),
+                  [&](alg::executor & ex) { sink = alg::any_of(ex, input.begin(), input.end(), matches); });
+    suite.compare(where, "none_of", nothing,
+                  [&] { sink = std::none_of(input.begin(), input.end(), matches); },
+                  ALG_BENCH_PAR(sink = std::none_of(std::execution::par, input.begin(), input.end(), matches)),
+                  [&](alg::executor & ex) { sink = alg::none_of(ex, input.begin(), input.end(), matches); });
+    suite.compare(where, "count_if", nothing,
+                  [&] { sink = std::count_if(input.begin(), input.end(), selected); },
+                  ALG_BENCH_PAR(sink = std::count_if(std::execution::par, input.begin(), input.end(), selected)),
+                  [&](alg::executor & ex) { sink = alg::count_if(ex, input.begin(), input.end(), selected); });
+    suite.compare(where, "count", nothing,
+                  [&] { sink = std::count(input.begin(), input.end(), target); },
+                  ALG_BENCH_PAR(sink = std::count(std::execution::par, input.begin(), input.end(), target)),
+                  [&](alg::executor & ex) { sink = alg::count(ex, input.begin(), input.end(), target); });
+    suite.compare(where, "histogram", nothing,
+                  [&]
+                  {
+                      std::vector<size_t> bins(256);
+                      for (const T & value : input)
+                          ++bins[keyOf(value) % 256];
+                      sink = bins[0];
+                  },
+                  nullptr,
+                  [&](alg::executor & ex) { sink = alg::histogram(ex, input.begin(), input.end(), 256, [](const T & value) { return keyOf(value) % 256; })[0]; });
+    suite.compare(where, "count_by_key", nothing,
+                  [&]
+                  {
+                      std::unordered_map<uint64_t, size_t> counts;
+                      for (const T & value : input)
+                          ++counts[keyOf(value) % 65536];
+                      sink = counts.size();
+                  },
+                  nullptr,
+                  [&](alg::executor & ex) { sink = alg::count_by_key(ex, input.begin(), input.end(), [](const T & value) { return keyOf(value) % 65536; }).size(); });
+    suite.compare(where, "for_each", nothing,
+                  [&] { std::for_each(work.begin(), work.end(), [](T & value) { value = bump(value); }); },
+                  ALG_BENCH_PAR(std::for_each(std::execution::par, work.begin(), work.end(), [](T & value) { value = bump(value); })),
+                  [&](alg::executor & ex) { alg::for_each(ex, work.begin(), work.end(), [](T & value) { value = bump(value); }); });
+    suite.compare(where, "transform", nothing,
+                  [&] { std::transform(input.begin(), input.end(), output.begin(), op); },
+                  ALG_BENCH_PAR(std::transform(std::execution::par, input.begin(), input.end(), output.begin(), op)),
+                  [&](alg::executor & ex) { alg::transform(ex, input.begin(), input.end(), output.begin(), op); });
+    suite.compare(where, "transform_binary", nothing,
+                  [&] { std::transform(input.begin(), input.end(), work.begin(), output.begin(), smaller); },
+                  ALG_BENCH_PAR(std::transform(std::execution::par, input.begin(), input.end(), work.begin(), output.begin(), smaller)),
+                  [&](alg::executor & ex) { alg::transform(ex, input.begin(), input.end(), work.begin(), output.begin(), smaller); });
+    suite.compare(where, "transform_n", nothing,
+                  [&] { std::transform(input.begin(), input.end(), output.begin(), op); },
+                  ALG_BENCH_PAR(std::transform(std::execution::par, input.begin(), input.end(), output.begin(), op)),
+                  [&](alg::executor & ex) { alg::transform_n(ex, input.begin(), n, output.begin(), op); });
+    suite.compare(where, "transform_reduce", nothing,
+                  [&] { sink = std::transform_reduce(input.begin(), input.end(), uint64_t(0), std::plus<>(), key); },
+                  ALG_BENCH_PAR(sink = std::transform_reduce(std::execution::par, input.begin(), input.end(), uint64_t(0), std::plus<>(), key)),
+                  [&](alg::executor & ex) { sink = alg::transform_reduce(ex, input.begin(), input.end(), uint64_t(0), std::plus<>(), key); });
+    suite.compare(where, "pipe_map_filter_count", nothing,
+                  [&] { sink = std::count_if(input.begin(), input.end(), [&](const T & value) { return selected(op(value)); }); },
+                  ALG_BENCH_PAR(sink = std::count_if(std::execution::par, input.begin(), input.end(), [&](const T & value) { return selected(op(value)); })),
+                  [&](alg::executor & ex) { sink = alg::pipe(ex, input) | alg::map(op) | alg::filter(selected) | alg::count(); });
+    suite.compare(where, "zip_for_each", nothing,
+                  [&]
+                  {
+                      It other = work.begin();
+                      for (It it = input.begin(); it != input.end(); ++it, ++other)
+                          *other = smaller(*it, *other);
+                  },
+                  nullptr,
+                  [&](alg::executor & ex) { alg::zip_for_each(ex, input.begin(), input.end(), work.begin(), [&](const T & item, T & other) { other = smaller(item, other); }); });
+    if constexpr (arithmetic)
+    {
+        suite.compare(where, "reduce", nothing,
+                      [&] { sink = static_cast<uint64_t>(std::reduce(input.begin(), input.end(), T())); },
+                      ALG_BENCH_PAR(sink = static_cast<uint64_t>(std::reduce(std::execution::par, input.begin(), input.end(), T()))),
+                      [&](alg::executor & ex) { sink = static_cast<uint64_t>(alg::reduce(ex, input.begin(), input.end(), T())); });
+        suite.compare(where, "accumulate", nothing,
+                      [&] { sink = static_cast<uint64_t>(std::accumulate(input.begin(), input.end(), T())); },
+                      nullptr,
+                      [&](alg::executor & ex) { sink = static_cast<uint64_t>(alg::accumulate(ex, input.begin(), input.end(), T())); });
+        if constexpr (randomAccess)
+        {
+            suite.compare(where, "inclusive_scan", nothing,
+                          [&] { std::inclusive_scan(input.begin(), input.end(), output.begin()); },
+                          ALG_BENCH_PAR(std::inclusive_scan(std::execution::par, input.begin(), input.end(), output.begin())),
+                          [&](alg::executor & ex) { alg::inclusive_scan(ex, input.begin(), input.end(), output.begin()); });
+            suite.compare(where, "exclusive_scan", nothing,
+                          [&] { std::exclusive_scan(input.begin(), input.end(), output.begin(), T()); },
+                          ALG_BENCH_PAR(std::exclusive_scan(std::execution::par, input.begin(), input.end(), output.begin(), T())),
+                          [&](alg::executor & ex) { alg::exclusive_scan(ex, input.begin(), input.end(), output.begin(), T()); });
+            suite.compare(where, "transform_inclusive_scan", nothing,
+                          [&] { std::transform_inclusive_scan(input.begin(), input.end(), output.begin(), std::plus<>(), op); },
+                          ALG_BENCH_PAR(std::transform_inclusive_scan(std::execution::par, input.begin(), input.end(), output.begin(), std::plus<>(), op)),
+                          [&](alg::executor & ex) { alg::transform_inclusive_scan(ex, input.begin(), input.end(), output.begin(), std::plus<>(), op); });
+            suite.compare(where, "transform_exclusive_scan", nothing,
+                          [&] { std::transform_exclusive_scan(input.begin(), input.end(), output.begin(), T(), std::plus<>(), op); },
+                          ALG_BENCH_PAR(std::transform_exclusive_scan(std::execution::par, input.begin(), input.end(), output.begin(), T(), std::plus<>(), op)),
+                          [&](alg::executor & ex) { alg::transform_exclusive_scan(ex, input.begin(), input.end(), output.begin(), T(), std::plus<>(), op); });
+        }
+    }
+    std::copy(input.begin(), input.end(), second.begin());
+    suite.compare(where, "mismatch", nothing,
+                  [&] { sink = std::mismatch(input.begin(), input.end(), second.begin()).first != input.end(); },
+                  ALG_BENCH_PAR(sink = std::mismatch(std::execution::par, input.begin(), input.end(), second.begin()).first != input.end()),
+                  [&](alg::executor & ex) { sink = alg::mismatch(ex, input.begin(), input.end(), second.begin()).first != input.end(); });
+    suite.compare(where, "mismatch_any", nothing,
+                  [&] { sink = std::mismatch(input.begin(), input.end(), second.begin()).first != input.end(); },
+                  ALG_BENCH_PAR(sink = std::mismatch(std::execution::par, input.begin(), input.end(), second.begin()).first != input.end()),
+                  [&](alg::executor & ex) { sink = alg::mismatch_any(ex, input.begin(), input.end(), second.begin()).first != input.end(); });
+    suite.compare(where, "equal", nothing,
+                  [&] { sink = std::equal(input.begin(), input.end(), second.begin()); },
+                  ALG_BENCH_PAR(sink = std::equal(std::execution::par, input.begin(), input.end(), second.begin())),
+                  [&](alg::executor & ex) { sink = alg::equal(ex, input.begin(), input.end(), second.begin()); });
+    suite.compare(where, "copy", nothing,
+                  [&] { std::copy(input.begin(), input.end(), output.begin()); },
+                  ALG_BENCH_PAR(std::copy(std::execution::par, input.begin(), input.end(), output.begin())),
+                  [&](alg::executor & ex) { alg::copy(ex, input.begin(), input.end(), output.begin()); });
+    suite.compare(where, "copy_n", nothing,
+                  [&] { std::copy_n(input.begin(), n, output.begin()); },
+                  ALG_BENCH_PAR(std::copy_n(std::execution::par, input.begin(), n, output.begin())),
+                  [&](alg::executor & ex) { alg::copy_n(ex, input.begin(), n, output.begin()); });
+    suite.compare(where, "copy_backward", nothing,
+                  [&] { std::copy_backward(input.begin(), input.end(), output.end()); },
+                  nullptr,
+                  [&](alg::executor & ex) { alg::copy_backward(ex, input.begin(), input.end(), output.end()); });
+    suite.compare(where, "move", restore,
+                  [&] { std::move(work.begin(), work.end(), output.begin()); },
+                  ALG_BENCH_PAR(std::move(std::execution::par, work.begin(), work.end(), output.begin())),
+                  [&](alg::executor & ex) { alg::move(ex, work.begin(), work.end(), output.begin()); });
+    suite.compare(where, "move_backward", restore,
+                  [&] { std::move_backward(work.begin(), work.end(), output.end()); },
+                  nullptr,
+                  [&](alg::executor & ex) { alg::move_backward(ex, work.begin(), work.end(), output.end()); });
+    suite.compare(where, "fill", nothing,
+                  [&] { std::fill(output.begin(), output.end(), target); },
+                  ALG_BENCH_PAR(std::fill(std::execution::par, output.begin(), output.end(), target)),
+                  [&](alg::executor & ex) { alg::fill(ex, output.begin(), output.end(), target); });
+    suite.compare(where, "fill_n", nothing,
+                  [&] { std::fill_n(output.begin(), n, target); },
+                  ALG_BENCH_PAR(std::fill_n(std::execution::par, output.begin(), n, target)),
+                  [&](alg::executor & ex) { alg::fill_n(ex, output.begin(), n, target); });
+    suite.compare(where, "generate", nothing,
+                  [&] { std::generate(output.begin(), output.end(), [&target] { return target; }); },
+                  ALG_BENCH_PAR(std::generate(std::execution::par, output.begin(), output.end(), [&target] { return target; })),
+                  [&](alg::executor & ex) { alg::generate(ex, output.begin(), output.end(), [&target] { return target; }); });
+    suite.compare(where, "generate_n", nothing,
+                  [&] { std::generate_n(output.begin(), n, [&target] { return target; }); },
+                  ALG_BENCH_PAR(std::generate_n(std::execution::par, output.begin(), n, [&target] { return target; })),
+                  [&](alg::executor & ex) { alg::generate_n(ex, output.begin(), n, [&target] { return target; }); });
+    std::mt19937_64 engine(1);
+    suite.compare(where, "generate_with_state", nothing,
+                  [&] { std::generate(output.begin(), output.end(), [&] { return makeValue<T>(engine() % (n + 1)); }); },
+                  nullptr,
+                  [&](alg::executor & ex)
+                  {
+                      std::atomic<uint64_t> seeds(0);
+                      alg::generate_with_state(ex, output.begin(), output.end(), [&seeds] { return std::mt19937_64(++seeds); },
+                                               [n](std::mt19937_64 & rng) { return makeValue<T>(rng() % (n + 1)); });
+                  });
+    suite.compare(where, "generate_random", nothing,
+                  [&] { std::generate(output.begin(), output.end(), [&] { return makeValue<T>(engine() % (n + 1)); }); },
+                  nullptr,
+                  [&](alg::executor & ex) { alg::generate_random(ex, output.begin(), output.end(), 1, [n](alg::philox4x32 & rng) { return makeValue<T>(rng() % (n + 1)); }); });
+    suite.compare(where, "reverse_copy", nothing,
+                  [&] { std::reverse_copy(input.begin(), input.end(), output.begin()); },
+                  ALG_BENCH_PAR(std::reverse_copy(std::execution::par, input.begin(), input.end(), output.begin())),
+                  [&](alg::executor & ex) { alg::reverce_copy(ex, input.begin(), input.end(), output.begin()); });
+    suite.compare(where, "replace_copy_if", nothing,
+                  [&] { std::replace_copy_if(input.begin(), input.end(), output.begin(), selected, replacement); },
+                  ALG_BENCH_PAR(std::replace_copy_if(std::execution::par, input.begin(), input.end(), output.begin(), selected, replacement)),
+                  [&](alg::executor & ex) { alg::replace_copy_if(ex, input.begin(), input.end(), output.begin(), selected, replacement); });
+    suite.compare(where, "replace_copy", nothing,
+                  [&] { std::replace_copy(input.begin(), input.end(), output.begin(), target, replacement); },
+                  ALG_BENCH_PAR(std::replace_copy(std::execution::par, input.begin(), input.end(), output.begin(), target, replacement)),
+                  [&](alg::executor & ex) { alg::replace_copy(ex, input.begin(), input.end(), output.begin(), target, replacement); });
+    suite.compare(where, "replace_if", restore,
+                  [&] { std::replace_if(work.begin(), work.end(), selected, replacement); },
+                  ALG_BENCH_PAR(std::replace_if(std::execution::par, work.begin(), work.end(), selected, replacement)),
+                  [&](alg::executor & ex) { alg::replace_if(ex, work.begin(), work.end(), selected, replacement); });
+    suite.compare(where, "replace", restore,
+                  [&] { std::replace(work.begin(), work.end(), target, replacement); },
+                  ALG_BENCH_PAR(std::replace(std::execution::par, work.begin(), work.end(), target, replacement)),
+                  [&](alg::executor & ex) { alg::replace(ex, work.begin(), work.end(), target, replacement); });
+    suite.compare(where, "copy_if", nothing,
+                  [&] { std::copy_if(input.begin(), input.end(), output.begin(), selected); },
+                  ALG_BENCH_PAR(std::copy_if(std::execution::par, input.begin(), input.end(), output.begin(), selected)),
+                  [&](alg::executor & ex) { alg::copy_if(ex, input.begin(), input.end(), output.begin(), selected); });
+    suite.compare(where, "remove_copy_if", nothing,
+                  [&] { std::remove_copy_if(input.begin(), input.end(), output.begin(), selected); },
+                  ALG_BENCH_PAR(std::remove_copy_if(std::execution::par, input.begin(), input.end(), output.begin(), selected)),
+                  [&](alg::executor & ex) { alg::remove_copy_if(ex, input.begin(), input.end(), output.begin(), selected); });
+    suite.compare(where, "remove_if", restore,
+                  [&] { std::remove_if(work.begin(), work.end(), selected); },
+                  ALG_BENCH_PAR(std::remove_if(std::execution::par, work.begin(), work.end(), selected)),
+                  [&](alg::executor & ex) { alg::remove_if(ex, work.begin(), work.end(), selected); });
+    suite.compare(where, "partition_copy", nothing,
+                  [&] { std::partition_copy(input.begin(), input.end(), output.begin(), second.begin(), selected); },
+                  ALG_BENCH_PAR(std::partition_copy(std::execution::par, input.begin(), input.end(), output.begin(), second.begin(), selected)),
+                  [&](alg::executor & ex) { alg::partition_copy(ex, input.begin(), input.end(), output.begin(), second.begin(), selected); });
+    // alg::partition is stable.
+    suite.compare(where, "partition", restore,
+                  [&] { std::stable_partition(work.begin(), work.end(), selected); },
+                  ALG_BENCH_PAR(std::stable_partition(std::execution::par, work.begin(), work.end(), selected)),
+                  [&](alg::executor & ex) { alg::partition(ex, work.begin(), work.end(), selected); });
+    suite.compare(where, "unique_copy", nothing,
+                  [&] { std::unique_copy(input.begin(), input.end(), output.begin()); },
+                  ALG_BENCH_PAR(std::unique_copy(std::execution::par, input.begin(), input.end(), output.begin())),
+                  [&](alg::executor & ex) { alg::unique_copy(ex, input.begin(), input.end(), output.begin()); });
+    if constexpr (randomAccess)
+    {
+        C halves(input);
+        It middle = halves.begin() + n / 2;
+        std::sort(halves.begin(), middle);
+        std::sort(middle, halves.end());
+        auto restoreHalves = [&] { std::copy(halves.begin(), halves.end(), work.begin()); };
+        suite.compare(where, "merge", nothing,
+                      [&] { std::merge(halves.begin(), middle, middle, halves.end(), output.begin()); },
+                      ALG_BENCH_PAR(std::merge(std::execution::par, halves.begin(), middle, middle, halves.end(), output.begin())),
+                      [&](alg::executor & ex) { alg::merge(ex, halves.begin(), middle, middle, halves.end(), output.begin()); });
+        suite.compare(where, "inplace_merge", restoreHalves,
+                      [&] { std::inplace_merge(work.begin(), work.begin() + n / 2, work.end()); },
+                      ALG_BENCH_PAR(std::inplace_merge(std::execution::par, work.begin(), work.begin() + n / 2, work.end())),
+                      [&](alg::executor & ex) { alg::inplace_merge(ex, work.begin(), work.begin() + n / 2, work.end()); });
+        suite.compare(where, "set_union", nothing,
+                      [&] { std::set_union(halves.begin(), middle, middle, halves.end(), output.begin()); },
+                      ALG_BENCH_PAR(std::set_union(std::execution::par, halves.begin(), middle, middle, halves.end(), output.begin())),
+                      [&](alg::executor & ex) { alg::set_union(ex, halves.begin(), middle, middle, halves.end(), output.begin()); });
+        suite.compare(where, "set_intersection", nothing,
+                      [&] { std::set_intersection(halves.begin(), middle, middle, halves.end(), output.begin()); },
+                      ALG_BENCH_PAR(std::set_intersection(std::execution::par, halves.begin(), middle, middle, halves.end(), output.begin())),
+                      [&](alg::executor & ex) { alg::set_intersection(ex, halves.begin(), middle, middle, halves.end(), output.begin()); });
+        suite.compare(where, "set_difference", nothing,
+                      [&] { std::set_difference(halves.begin(), middle, middle, halves.end(), output.begin()); },
+                      ALG_BENCH_PAR(std::set_difference(std::execution::par, halves.begin(), middle, middle, halves.end(), output.begin())),
+                      [&](alg::executor & ex) { alg::set_difference(ex, halves.begin(), middle, middle, halves.end(), output.begin()); });
+        suite.compare(where, "includes", nothing,
+                      [&] { sink = std::includes(halves.begin(), middle, middle, halves.end()); },
+                      ALG_BENCH_PAR(sink = std::includes(std::execution::par, halves.begin(), middle, middle, halves.end())),
+                      [&](alg::executor & ex) { sink = alg::includes(ex, halves.begin(), middle, middle, halves.end()); });
+        suite.compare(where, "sort", restore,
+                      [&] { std::sort(work.begin(), work.end()); },
+                      ALG_BENCH_PAR(std::sort(std::execution::par, work.begin(), work.end())),
+                      [&](alg::executor & ex) { alg::sort(ex, work.begin(), work.end()); });
+        suite.compare(where, "stable_sort", restore,
+                      [&] { std::stable_sort(work.begin(), work.end()); },
+                      ALG_BENCH_PAR(std::stable_sort(std::execution::par, work.begin(), work.end())),
+                      [&](alg::executor & ex) { alg::stable_sort(ex, work.begin(), work.end()); });
+        suite.compare(where, "nth_element", restore,
+                      [&] { std::nth_element(work.begin(), work.begin() + n / 2, work.end()); },
+                      ALG_BENCH_PAR(std::nth_element(std::execution::par, work.begin(), work.begin() + n / 2, work.end())),
+                      [&](alg::executor & ex) { alg::nth_element(ex, work.begin(), work.begin() + n / 2, work.end()); });
+        suite.compare(where, "partial_sort", restore,
+                      [&] { std::partial_sort(work.begin(), work.begin() + n / 1000, work.end()); },
+                      ALG_BENCH_PAR(std::partial_sort(std::execution::par, work.begin(), work.begin() + n / 1000, work.end())),
+                      [&](alg::executor & ex) { alg::partial_sort(ex, work.begin(), work.begin() + n / 1000, work.end()); });
+    }
+    (void)sink;
+}
+
+template <class T>
+void runType(Suite & suite, const char * type, size_t n)
+{
+    const Options & options = suite.settings();
+    auto fits = [&](size_t overhead) { return n * (bytesPerElement<T>() + overhead) * 5 <= options.maxBytes; };
+    if (contains(options.containers, "vector") && fits(containerOverhead<std::vector<T>>()))
+        runCases<std::vector<T>>(suite, Case{type, "vector", n});
+    if (contains(options.containers, "deque") && fits(containerOverhead<std::deque<T>>()))
+        runCases<std::deque<T>>(suite, Case{type, "deque", n});
+    if (contains(options.containers, "list") && fits(containerOverhead<std::list<T>>()))
+        runCases<std::list<T>>(suite, Case{type, "list", n});
+}
+
+void printUsage()
+{
+    std::printf("alg_bench [options]\n"
+                "  --out=FILE              JSON output (alg_bench.json)\n"
+                "  --min-exp=K --max-exp=K sizes 10^K, default 2..9\n"
+                "  --max-bytes=B           skip cases whose containers need more (1 GiB)\n"
+                "  --threads=1,2,4         thread counts (1 and powers of two up to the hardware)\n"
+                "  --types=int,double,record64,string\n"
+                "  --containers=vector,deque,list\n"
+                "  --algorithms=sort,copy  default every algorithm\n"
+                "  --min-time=S            time to spend per measurement (0.05)\n"
+                "  --max-reps=R            repetitions per measurement at most (20)\n");
+}
+
+bool parseOptions(int argc, char ** argv, Options & options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        size_t equals = argument.find('=');
+        std::string name = argument.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : argument.substr(equals + 1);
+        if (name == "--out")
+            options.out = value;
+        else if (name == "--min-exp")
+            options.minExponent = std::strtoull(value.c_str(), nullptr, 10);
+        else if (name == "--max-exp")
+            options.maxExponent = std::strtoull(value.c_str(), nullptr, 10);
+        else if (name == "--max-bytes")
+            options.maxBytes = std::strtoull(value.c_str(), nullptr, 10);
+        else if (name == "--threads")
+        {
+            options.threads.clear();
+            for (const std::string & item : splitList(value))
+                options.threads.push_back(std::max<size_t>(1, std::strtoull(item.c_str(), nullptr, 10)));
+        }
+        else if (name == "--types")
+            options.types = splitList(value);
+        else if (name == "--containers")
+            options.containers = splitList(value);
+        else if (name == "--algorithms")
+            options.algorithms = splitList(value);
+        else if (name == "--min-time")
+            options.minSeconds = std::strtod(value.c_str(), nullptr);
+        else if (name == "--max-reps")
+            options.maxRepetitions = std::max<size_t>(1, std::strtoull(value.c_str(), nullptr, 10));
+        else
+            return false;
+    }
+    if (options.threads.empty())
+    {
+        size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t threads = 1; threads < hardware; threads *= 2)
+            options.threads.push_back(threads);
+        options.threads.push_back(hardware);
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+    Suite suite(options);
+    size_t n = 1;
+    for (size_t exponent = 0; exponent <= options.maxExponent; ++exponent, n *= 10)
+    {
+        if (exponent < options.minExponent)
+            continue;
+        if (contains(options.types, "int"))
+            runType<int>(suite, "int", n);
+        if (contains(options.types, "double"))
+            runType<double>(suite, "double", n);
+        if (contains(options.types, "record64"))
+            runType<Record>(suite, "record64", n);
+        if (contains(options.types, "string"))
+            runType<std::string>(suite, "string", n);
+    }
+    if (!suite.write())
+    {
+        std::fprintf(stderr, "cannot write %s\n", options.out.c_str());
+        return 1;
+    }
+    return 0;
+}
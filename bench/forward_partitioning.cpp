@@ -0,0 +1,133 @@
+// alg::for_each / count_if / transform on std::list and std::map, contiguous blocks per part
+// against the old strided scheme where part i visits elements i, i + parts, i + 2 * parts, ...
+// g++ -std=c++17 -O2 -pthread forward_partitioning.cpp -o forward_partitioning
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <vector>
+#include "../alg.hpp"
+
+namespace
+{
+
+template <class It>
+void advanceNoFurther(size_t n, It & first, const It & last)
+{
+    for (; (n != 0) && (first != last); --n)
+        ++first;
+}
+
+// Every part walks the whole sequence and touches one element out of parts.
+template <class It, class Func>
+void stridedForEach(alg::executor & ex, It first, It last, const Func & f)
+{
+    ex.run(ex.concurrency(), [&](size_t i)
+    {
+        It current = first;
+        for (advanceNoFurther(i, current, last); current != last; advanceNoFurther(ex.concurrency(), current, last))
+            f(*current);
+    });
+}
+
+template <class It, class Func>
+size_t stridedCountIf(alg::executor & ex, It first, It last, const Func & f)
+{
+    std::atomic<size_t> result(0);
+    ex.run(ex.concurrency(), [&](size_t i)
+    {
+        size_t count = 0;
+        It current = first;
+        for (advanceNoFurther(i, current, last); current != last; advanceNoFurther(ex.concurrency(), current, last))
+            count += f(*current) ? 1 : 0;
+        result += count;
+    });
+    return result;
+}
+
+template <class InputIt, class OutputIt, class Func>
+void stridedTransform(alg::executor & ex, InputIt first, InputIt last, OutputIt d_first, const Func & f)
+{
+    ex.run(ex.concurrency(), [&](size_t i)
+    {
+        InputIt current = first;
+        OutputIt output = d_first;
+        for (size_t k = 0; (k != i) && (current != last); ++k, ++current, ++output);
+        while (current != last)
+        {
+            *output = f(*current);
+            for (size_t k = 0; (k != ex.concurrency()) && (current != last); ++k, ++current, ++output);
+        }
+    });
+}
+
+template <class Func>
+double medianMs(size_t repetitions, const Func & f)
+{
+    std::vector<double> times;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+void report(const char * container, const char * name, double strided, double blocks)
+{
+    std::printf("%-5s %-10s strided %9.3f ms   blocks %9.3f ms   x%.2f\n", container, name, strided, blocks, strided / blocks);
+}
+
+uint64_t work(uint64_t value)
+{
+    for (int i = 0; i < 16; ++i)
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    return value;
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+    size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+    alg::executor & ex = alg::default_executor();
+
+    std::list<uint64_t> list;
+    std::map<uint64_t, uint64_t> map;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        list.push_back(i);
+        map.emplace(i, i);
+    }
+    std::list<uint64_t> listOut(n);
+
+    std::printf("n = %zu, threads = %zu\n", n, ex.concurrency());
+    auto odd = [](uint64_t value) { return work(value) & 1; };
+    auto oddPair = [](const std::pair<const uint64_t, uint64_t> & value) { return work(value.second) & 1; };
+    volatile uint64_t sink = 0;
+
+    report("list", "for_each",
+           medianMs(repetitions, [&] { stridedForEach(ex, list.begin(), list.end(), [&](uint64_t & value) { value = work(value); }); }),
+           medianMs(repetitions, [&] { alg::for_each(ex, list.begin(), list.end(), [&](uint64_t & value) { value = work(value); }); }));
+    report("list", "count_if",
+           medianMs(repetitions, [&] { sink = stridedCountIf(ex, list.begin(), list.end(), odd); }),
+           medianMs(repetitions, [&] { sink = alg::count_if(ex, list.begin(), list.end(), odd); }));
+    report("list", "transform",
+           medianMs(repetitions, [&] { stridedTransform(ex, list.begin(), list.end(), listOut.begin(), work); }),
+           medianMs(repetitions, [&] { alg::transform(ex, list.begin(), list.end(), listOut.begin(), work); }));
+    report("map", "for_each",
+           medianMs(repetitions, [&] { stridedForEach(ex, map.begin(), map.end(), [&](std::pair<const uint64_t, uint64_t> & value) { value.second = work(value.second); }); }),
+           medianMs(repetitions, [&] { alg::for_each(ex, map.begin(), map.end(), [&](std::pair<const uint64_t, uint64_t> & value) { value.second = work(value.second); }); }));
+    report("map", "count_if",
+           medianMs(repetitions, [&] { sink = stridedCountIf(ex, map.begin(), map.end(), oddPair); }),
+           medianMs(repetitions, [&] { sink = alg::count_if(ex, map.begin(), map.end(), oddPair); }));
+    (void)sink;
+    return 0;
+}
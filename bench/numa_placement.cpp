@@ -0,0 +1,79 @@
+// Repeated alg::transform over a buffer that was first touched by one thread, against one placed by
+// alg::first_touch_fill, with unpinned workers and with workers pinned compact and spread over the nodes.
+// On a single node machine the columns only differ by the cost of pinning.
+// g++ -std=c++17 -O2 -pthread numa_placement.cpp -o numa_placement
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "../alg.hpp"
+
+namespace
+{
+
+template <class Func>
+double bestSeconds(size_t repetitions, const Func & f)
+{
+    double best = 0;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        if (i == 0 || seconds < best)
+            best = seconds;
+    }
+    return best;
+}
+
+// Bytes read and written per second by a transform from source into destination.
+template <class Vector>
+double transformRate(alg::executor & ex, size_t n, size_t repetitions, bool firstTouch)
+{
+    Vector source(n);
+    Vector destination(n);
+    if (firstTouch)
+    {
+        alg::first_touch_fill(ex, source.begin(), source.end(), uint64_t(1));
+        alg::first_touch_fill(ex, destination.begin(), destination.end(), uint64_t(0));
+    }
+    else
+    {
+        std::fill(source.begin(), source.end(), uint64_t(1));
+        std::fill(destination.begin(), destination.end(), uint64_t(0));
+    }
+    double seconds = bestSeconds(repetitions, [&]
+    {
+        alg::transform(ex, source.begin(), source.end(), destination.begin(), [](uint64_t item) { return item * 3 + 1; });
+    });
+    return 2.0 * n * sizeof(uint64_t) / (1 << 30) / seconds;
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+    size_t n = (mib << 20) / sizeof(uint64_t);
+
+    std::printf("buffer = %zu MiB, threads = %zu, nodes:", mib, alg::_num_of_threads);
+    for (const alg::numa_node & node : alg::numa_topology())
+        std::printf(" %zu (%zu cpus)", node.id, node.cpus.size());
+    std::printf("\n");
+    const char * names[] = {"none", "compact", "spread"};
+    alg::affinity policies[] = {alg::affinity::none, alg::affinity::compact, alg::affinity::spread};
+    for (size_t i = 0; i < 3; ++i)
+    {
+        alg::executor ex(alg::_num_of_threads, policies[i]);
+        if (!ex.cpus().empty())
+            alg::pin_this_thread(ex.cpus()[0]);
+        double serial = transformRate<std::vector<uint64_t>>(ex, n, repetitions, false);
+        double placed = transformRate<alg::first_touch_vector<uint64_t>>(ex, n, repetitions, true);
+        std::printf("%-8s serial first touch %7.2f GiB/s   first_touch_fill %7.2f GiB/s\n", names[i], serial, placed);
+    }
+    return 0;
+}
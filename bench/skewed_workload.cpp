@@ -0,0 +1,87 @@
+// Tail latency of alg::for_each / count_if / transform on a skewed per-element cost,
+// static chunks (grain larger than any chunk) against work stealing with the automatic grain.
+// g++ -std=c++17 -O2 -pthread skewed_workload.cpp -o skewed_workload
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "../alg.hpp"
+
+namespace
+{
+
+// Roughly parsing a record whose length is stored in the element.
+uint64_t parseRecord(uint32_t length)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (uint32_t i = 0; i < length; ++i)
+        hash = (hash ^ i) * 1099511628211ULL;
+    return hash;
+}
+
+struct Timing
+{
+    double median;
+    double max;
+};
+
+template <class Func>
+Timing measure(size_t repetitions, const Func & f)
+{
+    std::vector<double> times;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return Timing{times[times.size() / 2], times.back()};
+}
+
+void report(const char * name, const char * mode, const Timing & timing)
+{
+    std::printf("%-10s %-8s median %9.3f ms   max %9.3f ms\n", name, mode, timing.median, timing.max);
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+    size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+    // The first eighth of the records is 64 times longer than the rest.
+    std::vector<uint32_t> lengths(n);
+    for (size_t i = 0; i < n; ++i)
+        lengths[i] = i < n / 8 ? 512 : 8;
+    std::vector<uint64_t> hashes(n);
+
+    std::printf("n = %zu, threads = %u\n", n, static_cast<unsigned>(alg::_num_of_threads));
+    for (size_t grain : {std::numeric_limits<size_t>::max(), size_t(0)})
+    {
+        alg::set_grain_size(grain);
+        const char * mode = grain == 0 ? "stealing" : "static";
+        report("for_each", mode, measure(repetitions, [&]
+        {
+            alg::for_each(lengths.begin(), lengths.end(), [&](const uint32_t & length)
+            {
+                hashes[&length - lengths.data()] = parseRecord(length);
+            });
+        }));
+        report("count_if", mode, measure(repetitions, [&]
+        {
+            alg::count_if(lengths.begin(), lengths.end(), [](uint32_t length) { return parseRecord(length) & 1; });
+        }));
+        report("transform", mode, measure(repetitions, [&]
+        {
+            alg::transform(lengths.begin(), lengths.end(), hashes.begin(), parseRecord);
+        }));
+    }
+    alg::set_grain_size(0);
+    return 0;
+}
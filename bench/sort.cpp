@@ -0,0 +1,72 @@
+// alg::sort / alg::stable_sort against std::sort / std::stable_sort on 10^6 .. 10^max_exponent elements.
+// g++ -std=c++17 -O2 -pthread sort.cpp -o sort
+// ./sort [max_exponent = 8] [repetitions = 3]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../alg.hpp"
+
+namespace
+{
+
+struct Record
+{
+    uint64_t key;
+    uint64_t payload[3];
+};
+
+bool byKey(const Record & left, const Record & right)
+{
+    return left.key < right.key;
+}
+
+template <class T, class Generator, class Sort>
+double measure(size_t n, size_t repetitions, const Generator & generate, const Sort & sortF)
+{
+    std::vector<T> data(n);
+    double best = 0;
+    for (size_t r = 0; r < repetitions; ++r)
+    {
+        std::mt19937_64 rng(r);
+        for (T & item : data)
+            item = generate(rng);
+        auto start = std::chrono::steady_clock::now();
+        sortF(data);
+        auto stop = std::chrono::steady_clock::now();
+        double time = std::chrono::duration<double, std::milli>(stop - start).count();
+        best = r == 0 ? time : std::min(best, time);
+    }
+    return best;
+}
+
+template <class T, class Generator, class Compare>
+void compare(const char * name, size_t n, size_t repetitions, const Generator & generate, const Compare & comp)
+{
+    double stdSort = measure<T>(n, repetitions, generate, [&](std::vector<T> & data) { std::sort(data.begin(), data.end(), comp); });
+    double algSort = measure<T>(n, repetitions, generate, [&](std::vector<T> & data) { alg::sort(data.begin(), data.end(), comp); });
+    double stdStable = measure<T>(n, repetitions, generate, [&](std::vector<T> & data) { std::stable_sort(data.begin(), data.end(), comp); });
+    double algStable = measure<T>(n, repetitions, generate, [&](std::vector<T> & data) { alg::stable_sort(data.begin(), data.end(), comp); });
+    std::printf("%-8s %11zu  sort: std %10.2f ms  alg %10.2f ms  x%5.2f   stable_sort: std %10.2f ms  alg %10.2f ms  x%5.2f\n",
+                name, n, stdSort, algSort, stdSort / algSort, stdStable, algStable, stdStable / algStable);
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    size_t maxExponent = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8;
+    size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3;
+    std::printf("threads = %u\n", static_cast<unsigned>(alg::_num_of_threads));
+    size_t n = 1000000;
+    for (size_t exponent = 6; exponent <= maxExponent; ++exponent, n *= 10)
+    {
+        compare<uint32_t>("uint32", n, repetitions, [](std::mt19937_64 & rng) { return static_cast<uint32_t>(rng()); }, std::less<uint32_t>());
+        compare<double>("double", n, repetitions, [](std::mt19937_64 & rng) { return std::normal_distribution<double>()(rng); }, std::less<double>());
+        compare<Record>("record", n, repetitions, [](std::mt19937_64 & rng) { return Record{rng(), {}}; }, byKey);
+    }
+    return 0;
+}
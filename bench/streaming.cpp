@@ -0,0 +1,96 @@
+// Numbers parsed from a text stream with std::istream_iterator: read into a vector first and then
+// alg::count_if / alg::transform over it, against the streaming mode that works on batches while the next
+// ones are parsed. The last column is the largest number of items held at once.
+// g++ -std=c++17 -O2 -pthread streaming.cpp -o streaming
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../alg.hpp"
+
+namespace
+{
+
+template <class Func>
+double medianMs(size_t repetitions, const Func & f)
+{
+    std::vector<double> times;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+uint64_t work(uint64_t value)
+{
+    for (int i = 0; i < 64; ++i)
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    return value;
+}
+
+void report(const char * name, double loaded, size_t loadedItems, double streamed, size_t streamedItems)
+{
+    std::printf("%-10s load first %9.3f ms (%9zu items)   streaming %9.3f ms (%7zu items)\n",
+                name, loaded, loadedItems, streamed, streamedItems);
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+    size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+    alg::executor & ex = alg::default_executor();
+
+    std::string text;
+    for (uint64_t i = 0; i < n; ++i)
+        text += std::to_string(i * 2654435761u) + '\n';
+    size_t inFlight = 2 * ex.concurrency() * alg::stream_batch_size();
+    std::printf("n = %zu, threads = %zu, batch = %zu\n", n, ex.concurrency(), alg::stream_batch_size());
+    auto odd = [](uint64_t value) { return work(value) & 1; };
+    volatile uint64_t sink = 0;
+
+    report("count_if",
+           medianMs(repetitions, [&]
+           {
+               std::istringstream in(text);
+               std::vector<uint64_t> items{std::istream_iterator<uint64_t>(in), std::istream_iterator<uint64_t>()};
+               sink = alg::count_if(ex, items.begin(), items.end(), odd);
+           }), n,
+           medianMs(repetitions, [&]
+           {
+               std::istringstream in(text);
+               sink = alg::count_if(ex, std::istream_iterator<uint64_t>(in), std::istream_iterator<uint64_t>(), odd);
+           }), inFlight);
+    report("transform",
+           medianMs(repetitions, [&]
+           {
+               std::istringstream in(text);
+               std::vector<uint64_t> items{std::istream_iterator<uint64_t>(in), std::istream_iterator<uint64_t>()};
+               std::vector<uint64_t> out(items.size());
+               alg::transform(ex, items.begin(), items.end(), out.begin(), work);
+               std::ostringstream result;
+               std::copy(out.begin(), out.end(), std::ostream_iterator<uint64_t>(result, "\n"));
+               sink = result.str().size();
+           }), 2 * n,
+           medianMs(repetitions, [&]
+           {
+               std::istringstream in(text);
+               std::ostringstream result;
+               alg::transform(ex, std::istream_iterator<uint64_t>(in), std::istream_iterator<uint64_t>(),
+                              std::ostream_iterator<uint64_t>(result, "\n"), work);
+               sink = result.str().size();
+           }), 2 * inFlight);
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Selecting the k smallest of n random uint32 for a range of k / n: std::nth_element against
+// alg::nth_element, std::partial_sort against alg::partial_sort, and std::partial_sort_copy against
+// alg::partial_sort_copy, which leaves the input alone as alg::top_k does.
+// g++ -std=c++17 -O2 -pthread top_k.cpp -o top_k
+// ./top_k [n = 10^7] [repetitions = 3]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../alg.hpp"
+
+namespace
+{
+
+// Best time of f over fresh copies of input; the copy is not timed.
+template <class Func>
+double measure(const std::vector<uint32_t> & input, size_t repetitions, const Func & f)
+{
+    std::vector<uint32_t> data;
+    double best = 0;
+    for (size_t r = 0; r < repetitions; ++r)
+    {
+        data = input;
+        auto start = std::chrono::steady_clock::now();
+        f(data);
+        auto stop = std::chrono::steady_clock::now();
+        double time = std::chrono::duration<double, std::milli>(stop - start).count();
+        best = r == 0 ? time : std::min(best, time);
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3;
+    std::vector<uint32_t> input(n);
+    std::mt19937_64 rng(1);
+    for (uint32_t & item : input)
+        item = static_cast<uint32_t>(rng());
+    std::printf("n = %zu, threads = %u\n", n, static_cast<unsigned>(alg::_num_of_threads));
+
+    for (size_t k : {size_t(1), size_t(1000), n / 1000, n / 100, n / 10, n / 2})
+    {
+        if ((k == 0) || (k > n))
+            continue;
+        std::vector<uint32_t> out(k);
+        double stdNth = measure(input, repetitions, [&](std::vector<uint32_t> & data) { std::nth_element(data.begin(), data.begin() + k - 1, data.end()); });
+        double algNth = measure(input, repetitions, [&](std::vector<uint32_t> & data) { alg::nth_element(data.begin(), data.begin() + k - 1, data.end()); });
+        double stdPartial = measure(input, repetitions, [&](std::vector<uint32_t> & data) { std::partial_sort(data.begin(), data.begin() + k, data.end()); });
+        double algPartial = measure(input, repetitions, [&](std::vector<uint32_t> & data) { alg::partial_sort(data.begin(), data.begin() + k, data.end()); });
+        double stdCopy = measure(input, repetitions, [&](std::vector<uint32_t> & data) { std::partial_sort_copy(data.begin(), data.end(), out.begin(), out.end()); });
+        double algCopy = measure(input, repetitions, [&](std::vector<uint32_t> & data) { alg::partial_sort_copy(data.begin(), data.end(), out.begin(), out.end()); });
+        std::printf("k = %10zu (k/n %8.5f)  nth_element: std %9.2f ms alg %9.2f ms   partial_sort: std %9.2f ms alg %9.2f ms   "
+                    "partial_sort_copy: std %9.2f ms alg %9.2f ms\n",
+                    k, double(k) / n, stdNth, algNth, stdPartial, algPartial, stdCopy, algCopy);
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Heap allocations per call of the algorithms whose dispatch path should not allocate: every algorithm
+// runs once to warm the scratch caches, then the global operator new counts what repeated calls do.
+// Algorithms that need a data buffer or return a container (sort, stable_sort, partition, merge,
+// histogram, reduce_by_key, ...) are left out. Exits with 1 if any of the listed ones allocates. Builds
+// with ALG_INSTRUMENTATION allocate a record per call, so ctest only runs it without instrumentation.
+// g++ -std=c++17 -O2 -pthread dispatch_allocations.cpp -o dispatch_allocations
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <new>
+#include <vector>
+#include "../alg.hpp"
+#include "../algPipe.hpp"
+
+namespace
+{
+
+std::atomic<size_t> allocations(0);
+
+void * countedNew(size_t size, size_t alignment)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void * res = nullptr;
+    if (alignment <= alignof(std::max_align_t))
+        res = std::malloc(size == 0 ? 1 : size);
+    else
+        res = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (res == nullptr)
+        throw std::bad_alloc();
+    return res;
+}
+
+template <class Func>
+bool check(const char * name, size_t repetitions, const Func & f)
+{
+    f();
+    size_t before = allocations.load();
+    for (size_t i = 0; i < repetitions; ++i)
+        f();
+    size_t count = allocations.load() - before;
+    std::printf("%-24s %8.2f allocations per call\n", name, double(count) / repetitions);
+    return count == 0;
+}
+
+}
+
+void * operator new(size_t size) { return countedNew(size, alignof(std::max_align_t)); }
+void * operator new[](size_t size) { return countedNew(size, alignof(std::max_align_t)); }
+void * operator new(size_t size, std::align_val_t alignment) { return countedNew(size, size_t(alignment)); }
+void * operator new[](size_t size, std::align_val_t alignment) { return countedNew(size, size_t(alignment)); }
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete[](void * p) noexcept { std::free(p); }
+void operator delete(void * p, size_t) noexcept { std::free(p); }
+void operator delete[](void * p, size_t) noexcept { std::free(p); }
+void operator delete(void * p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void * p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void * p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+int main(int argc, char ** argv)
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 16;
+    size_t repetitions = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+    // More participants than one per CPU still takes every parallel path.
+    alg::executor ex(argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4);
+
+    std::vector<int> items(n);
+    for (size_t i = 0; i < n; ++i)
+        items[i] = int(i * 2654435761u % 1000);
+    std::vector<int> other(items);
+    std::vector<int> out(n);
+    std::list<int> listed(items.begin(), items.end());
+    std::list<int> listedOut(n);
+    auto odd = [](int value) { return (value & 1) != 0; };
+    auto twice = [](int value) { return 2 * value; };
+    volatile long sink = 0;
+    bool clean = true;
+
+    std::printf("n = %zu, threads = %zu\n", n, ex.concurrency());
+    clean &= check("for_each", repetitions, [&] { alg::for_each(ex, items.begin(), items.end(), [](int & value) { value ^= 1; }); });
+    clean &= check("for_each list", repetitions, [&] { alg::for_each(ex, listed.begin(), listed.end(), [](int & value) { value ^= 1; }); });
+    clean &= check("count_if", repetitions, [&] { sink = alg::count_if(ex, items.begin(), items.end(), odd); });
+    clean &= check("count_if list", repetitions, [&] { sink = alg::count_if(ex, listed.begin(), listed.end(), odd); });
+    clean &= check("reduce", repetitions, [&] { sink = alg::reduce(ex, items.begin(), items.end(), 0L, std::plus<>()); });
+    clean &= check("reduce list", repetitions, [&] { sink = alg::reduce(ex, listed.begin(), listed.end(), 0L, std::plus<>()); });
+    clean &= check("transform_reduce", repetitions, [&]
+    {
+        sink = alg::transform_reduce(ex, items.begin(), items.end(), other.begin(), 0L, std::plus<>(), std::multiplies<>());
+    });
+    clean &= check("all_of", repetitions, [&] { sink = alg::all_of(ex, items.begin(), items.end(), [](int value) { return value >= 0; }); });
+    clean &= check("find", repetitions, [&] { sink = *alg::find(ex, items.begin(), items.end(), 999); });
+    clean &= check("find list", repetitions, [&] { sink = *alg::find(ex, listed.begin(), listed.end(), 999); });
+    clean &= check("mismatch", repetitions, [&] { sink = alg::mismatch(ex, items.begin(), items.end(), other.begin()).first - items.begin(); });
+    clean &= check("equal", repetitions, [&] { sink = alg::equal(ex, items.begin(), items.end(), other.begin()); });
+    clean &= check("transform", repetitions, [&] { alg::transform(ex, items.begin(), items.end(), out.begin(), twice); });
+    clean &= check("transform list", repetitions, [&] { alg::transform(ex, listed.begin(), listed.end(), listedOut.begin(), twice); });
+    clean &= check("transform_n", repetitions, [&] { alg::transform_n(ex, items.begin(), n, out.begin(), twice); });
+    clean &= check("copy", repetitions, [&] { alg::copy(ex, items.begin(), items.end(), out.begin()); });
+    clean &= check("fill", repetitions, [&] { alg::fill(ex, out.begin(), out.end(), 7); });
+    clean &= check("replace", repetitions, [&] { alg::replace(ex, out.begin(), out.end(), 7, 8); });
+    clean &= check("copy_if", repetitions, [&] { sink = alg::copy_if(ex, items.begin(), items.end(), out.begin(), odd) - out.begin(); });
+    clean &= check("inclusive_scan", repetitions, [&] { alg::inclusive_scan(ex, items.begin(), items.end(), out.begin()); });
+    clean &= check("pipe count", repetitions, [&] { sink = alg::pipe(ex, items) | alg::map(twice) | alg::filter(odd) | alg::count(); });
+    std::printf(clean ? "no allocations\n" : "some dispatch paths allocate\n");
+    (void)sink;
+    return clean ? 0 : 1;
+}
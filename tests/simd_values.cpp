@@ -0,0 +1,59 @@
+// find, count and replace against std with items whose type differs from the elements: the vector kernels
+// must find exactly the elements that compare equal to the item under ==, mixed signedness included.
+// Exits with 1 on the first disagreement.
+// g++ -std=c++17 -O2 -pthread simd_values.cpp -o simd_values
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "../alg.hpp"
+
+namespace
+{
+
+template <class V, class T>
+bool check(alg::executor & ex, const char * name, const std::vector<V> & items, const T & item, const T & replacement)
+{
+    bool same = true;
+    same &= alg::count(ex, items.begin(), items.end(), item) == std::count(items.begin(), items.end(), item);
+    same &= alg::find(ex, items.begin(), items.end(), item) == std::find(items.begin(), items.end(), item);
+    std::vector<V> replaced(items);
+    std::vector<V> expected(items);
+    alg::replace(ex, replaced.begin(), replaced.end(), item, replacement);
+    std::replace(expected.begin(), expected.end(), item, replacement);
+    same &= replaced == expected;
+    if (!same)
+        std::printf("%s differs from std\n", name);
+    return same;
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+    alg::executor ex(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4);
+    size_t n = 100000;
+    bool clean = true;
+
+    std::vector<uint8_t> bytes(n, 255);
+    bytes[n / 2] = 1;
+    clean &= check(ex, "uint8_t, signed char -1", bytes, static_cast<signed char>(-1), static_cast<signed char>(2));
+    clean &= check(ex, "uint8_t, int 255", bytes, 255, 3);
+    clean &= check(ex, "uint8_t, int 511", bytes, 511, 3);
+
+    std::vector<int8_t> chars(n, -1);
+    clean &= check(ex, "int8_t, unsigned char 255", chars, static_cast<unsigned char>(255), static_cast<unsigned char>(2));
+    clean &= check(ex, "int8_t, int -1", chars, -1, 2);
+
+    std::vector<uint32_t> words(n, 0xFFFFFFFFu);
+    clean &= check(ex, "uint32_t, int -1", words, -1, 2);
+    std::vector<uint16_t> halves(n, 0xFFFF);
+    clean &= check(ex, "uint16_t, short -1", halves, static_cast<short>(-1), static_cast<short>(2));
+
+    std::vector<int32_t> ints(n, -1);
+    clean &= check(ex, "int32_t, unsigned -1", ints, 0xFFFFFFFFu, 2u);
+    clean &= check(ex, "int32_t, int64_t 2^32 - 1", ints, int64_t(0xFFFFFFFF), int64_t(2));
+
+    std::printf(clean ? "all match std\n" : "some differ from std\n");
+    return clean ? 0 : 1;
+}